@@ -16,6 +16,7 @@ private:
     SightRead::HopoThreshold m_hopo_threshold;
     std::set<SightRead::Instrument> m_permitted_instruments;
     bool m_permit_solos;
+    unsigned int m_worker_threads;
 
 public:
     explicit ChartParser(SightRead::Metadata metadata);
@@ -23,6 +24,11 @@ public:
     ChartParser&
     permit_instruments(std::set<SightRead::Instrument> permitted_instruments);
     ChartParser& parse_solos(bool permit_solos);
+    // Sets the number of threads used to lex and convert sections. The default
+    // of 1 does all the work on the calling thread.
+    ChartParser& worker_threads(unsigned int thread_count);
+    // data is expected to be UTF-8, but UTF-16 with a BOM is transcoded
+    // first. A UTF-8 BOM is skipped.
     SightRead::Song parse(std::string_view data) const;
 };
 }
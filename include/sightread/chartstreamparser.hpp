@@ -0,0 +1,53 @@
+#ifndef SIGHTREAD_CHARTSTREAMPARSER_HPP
+#define SIGHTREAD_CHARTSTREAMPARSER_HPP
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "sightread/hopothreshold.hpp"
+#include "sightread/metadata.hpp"
+#include "sightread/song.hpp"
+#include "sightread/songparts.hpp"
+
+namespace SightRead {
+// Parses a .chart that arrives in chunks of any size, such as from a socket.
+// Each section is converted as soon as its closing brace arrives, so only the
+// section currently being received is buffered. The result and any error are
+// the same as ChartParser::parse on the whole input, except that only UTF-8
+// input is accepted; a ParseError is thrown if the input starts with a UTF-16
+// BOM. The builder methods must be called before the first push.
+class ChartStreamParser {
+private:
+    enum class SectionState { Header, OpeningBrace, Body };
+
+    SightRead::Metadata m_metadata;
+    SightRead::HopoThreshold m_hopo_threshold;
+    std::set<SightRead::Instrument> m_permitted_instruments;
+    bool m_permit_solos;
+    SightRead::Song m_song;
+    std::string m_buffer;
+    std::size_t m_scan_offset {0};
+    SectionState m_state {SectionState::Header};
+    bool m_is_at_first_line {true};
+    bool m_is_bom_checked {false};
+
+    bool check_bom(bool is_last_chunk);
+    void read_complete_lines();
+    void add_sections(std::string_view text);
+
+public:
+    explicit ChartStreamParser(SightRead::Metadata metadata);
+    ChartStreamParser& hopo_threshold(SightRead::HopoThreshold hopo_threshold);
+    ChartStreamParser&
+    permit_instruments(std::set<SightRead::Instrument> permitted_instruments);
+    ChartStreamParser& parse_solos(bool permit_solos);
+    void push(std::string_view chunk);
+    // Parses whatever is left once all the input has been pushed. The parser
+    // should not be used afterwards.
+    SightRead::Song finish();
+};
+}
+
+#endif
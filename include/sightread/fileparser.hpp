@@ -0,0 +1,32 @@
+#ifndef SIGHTREAD_FILEPARSER_HPP
+#define SIGHTREAD_FILEPARSER_HPP
+
+#include <filesystem>
+#include <set>
+
+#include "sightread/hopothreshold.hpp"
+#include "sightread/metadata.hpp"
+#include "sightread/song.hpp"
+#include "sightread/songparts.hpp"
+
+namespace SightRead {
+// The settings for parse_file, matching the builder methods on ChartParser and
+// MidiParser.
+struct ParseOptions {
+    SightRead::Metadata metadata;
+    SightRead::HopoThreshold hopo_threshold {
+        SightRead::HopoThresholdType::Resolution, SightRead::Tick {0}};
+    std::set<SightRead::Instrument> permitted_instruments {
+        SightRead::all_instruments()};
+    bool permit_solos {true};
+    unsigned int worker_threads {1};
+};
+
+// Parses the .chart or .mid file at path. The file is memory-mapped rather
+// than read into a buffer, and is treated as a MIDI file if it starts with
+// MThd and as a .chart otherwise.
+SightRead::Song parse_file(const std::filesystem::path& path,
+                           const ParseOptions& options = {});
+}
+
+#endif
@@ -17,6 +17,7 @@ private:
     SightRead::HopoThreshold m_hopo_threshold;
     std::set<SightRead::Instrument> m_permitted_instruments;
     bool m_permit_solos;
+    unsigned int m_worker_threads;
 
 public:
     explicit MidiParser(SightRead::Metadata metadata);
@@ -24,6 +25,10 @@ public:
     MidiParser&
     permit_instruments(std::set<SightRead::Instrument> permitted_instruments);
     MidiParser& parse_solos(bool permit_solos);
+    // Sets the number of threads used to decode track chunks and convert
+    // instrument tracks. The default of 1 does all the work on the calling
+    // thread.
+    MidiParser& worker_threads(unsigned int thread_count);
     SightRead::Song parse(std::span<const std::uint8_t> data) const;
 };
 }
@@ -90,6 +90,10 @@ public:
     NoteFlags flags {0};
 
     [[nodiscard]] int colours() const;
+    // The sustain ticks the note adds to the base score: a chord whose
+    // sustains are all the same length counts that length once, otherwise
+    // every sustain counts.
+    [[nodiscard]] SightRead::Tick sustain_ticks() const;
     void merge_non_opens_into_open();
     void disable_dynamics();
     [[nodiscard]] bool is_kick_note() const;
@@ -189,8 +193,9 @@ private:
     int m_base_score_ticks;
 
     void compute_base_score_ticks();
+    void set_base_score_ticks(SightRead::Tick total_ticks);
     void merge_same_time_notes();
-    void add_hopos(SightRead::Tick max_hopo_gap);
+    void build_notes(SightRead::Tick max_hopo_gap);
 
 public:
     NoteTrack(std::vector<Note> notes, const std::vector<StarPower>& sp_phrases,
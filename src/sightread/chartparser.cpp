@@ -3,6 +3,7 @@
 #include "sightread/chartparser.hpp"
 #include "sightread/detail/chart.hpp"
 #include "sightread/detail/chartconverter.hpp"
+#include "sightread/detail/textencoding.hpp"
 
 SightRead::ChartParser::ChartParser(SightRead::Metadata metadata)
     : m_metadata {std::move(metadata)}
@@ -10,6 +11,7 @@ SightRead::ChartParser::ChartParser(SightRead::Metadata metadata)
                         SightRead::Tick {0}}
     , m_permitted_instruments {SightRead::all_instruments()}
     , m_permit_solos {true}
+    , m_worker_threads {1}
 {
 }
 
@@ -33,13 +35,29 @@ SightRead::ChartParser& SightRead::ChartParser::parse_solos(bool permit_solos)
     return *this;
 }
 
-SightRead::Song SightRead::ChartParser::parse(std::string_view data) const
+SightRead::ChartParser&
+SightRead::ChartParser::worker_threads(unsigned int thread_count)
 {
-    const auto chart = SightRead::Detail::parse_chart(data);
+    m_worker_threads = thread_count;
+    return *this;
+}
 
+SightRead::Song SightRead::ChartParser::parse(std::string_view data) const
+{
     const auto converter = SightRead::Detail::ChartConverter(m_metadata)
                                .hopo_threshold(m_hopo_threshold)
                                .permit_instruments(m_permitted_instruments)
-                               .parse_solos(m_permit_solos);
-    return converter.convert(chart);
+                               .parse_solos(m_permit_solos)
+                               .worker_threads(m_worker_threads);
+    // The lexed sections point into the text, so the transcoded copy has to
+    // outlive the lexer.
+    const auto utf8_data = SightRead::Detail::transcode_utf16(data);
+    if (utf8_data.has_value()) {
+        data = *utf8_data;
+    }
+    data = SightRead::Detail::skip_utf8_bom(data);
+
+    SightRead::Detail::ChartLexer lexer {data, m_permitted_instruments,
+                                        m_worker_threads};
+    return converter.convert(lexer);
 }
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <utility>
+
+#include "sightread/chartstreamparser.hpp"
+#include "sightread/detail/chart.hpp"
+#include "sightread/detail/chartconverter.hpp"
+#include "sightread/tempomap.hpp"
+
+namespace {
+std::string_view skip_whitespace(std::string_view input)
+{
+    const auto first_non_ws_location = input.find_first_not_of(" \f\n\r\t\v");
+    input.remove_prefix(std::min(first_non_ws_location, input.size()));
+    return input;
+}
+}
+
+SightRead::ChartStreamParser::ChartStreamParser(SightRead::Metadata metadata)
+    : m_metadata {std::move(metadata)}
+    , m_hopo_threshold {SightRead::HopoThresholdType::Resolution,
+                        SightRead::Tick {0}}
+    , m_permitted_instruments {SightRead::all_instruments()}
+    , m_permit_solos {true}
+    , m_song {SightRead::Detail::ChartConverter(m_metadata).new_song()}
+{
+}
+
+SightRead::ChartStreamParser& SightRead::ChartStreamParser::hopo_threshold(
+    SightRead::HopoThreshold hopo_threshold)
+{
+    m_hopo_threshold = hopo_threshold;
+    return *this;
+}
+
+SightRead::ChartStreamParser& SightRead::ChartStreamParser::permit_instruments(
+    std::set<SightRead::Instrument> permitted_instruments)
+{
+    m_permitted_instruments = std::move(permitted_instruments);
+    return *this;
+}
+
+SightRead::ChartStreamParser&
+SightRead::ChartStreamParser::parse_solos(bool permit_solos)
+{
+    m_permit_solos = permit_solos;
+    return *this;
+}
+
+// Skips a UTF-8 BOM and rejects UTF-16 ones. Returns false if there is not
+// yet enough input to tell.
+bool SightRead::ChartStreamParser::check_bom(bool is_last_chunk)
+{
+    constexpr std::string_view UTF8_BOM {"\xEF\xBB\xBF"};
+    constexpr std::string_view UTF16_LE_BOM {"\xFF\xFE"};
+    constexpr std::string_view UTF16_BE_BOM {"\xFE\xFF"};
+
+    if (m_is_bom_checked) {
+        return true;
+    }
+    const std::string_view buffer {m_buffer};
+    for (auto bom : {UTF8_BOM, UTF16_LE_BOM, UTF16_BE_BOM}) {
+        if (!is_last_chunk && buffer.size() < bom.size()
+            && bom.starts_with(buffer)) {
+            return false;
+        }
+    }
+    if (buffer.starts_with(UTF16_LE_BOM) || buffer.starts_with(UTF16_BE_BOM)) {
+        throw SightRead::ParseError("UTF-16 charts can not be streamed");
+    }
+    if (buffer.starts_with(UTF8_BOM)) {
+        m_buffer.erase(0, UTF8_BOM.size());
+    }
+    m_is_bom_checked = true;
+    return true;
+}
+
+// Tracks section structure line by line, the same way the lexer reads lines,
+// and converts each section once its closing brace is read. Anything
+// malformed is handed to the lexer straight away so it throws the usual
+// error.
+void SightRead::ChartStreamParser::read_complete_lines()
+{
+    while (true) {
+        const auto newline_location = m_buffer.find('\n', m_scan_offset);
+        if (newline_location == std::string::npos) {
+            return;
+        }
+        auto line = std::string_view {m_buffer}.substr(
+            m_scan_offset, newline_location - m_scan_offset);
+        m_scan_offset = newline_location + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!m_is_at_first_line) {
+            line = skip_whitespace(line);
+            if (line.empty()) {
+                continue;
+            }
+        }
+        m_is_at_first_line = false;
+
+        switch (m_state) {
+        case SectionState::Header: {
+            // The lexer's first line is left as is, so drop the blank lines
+            // and indentation before the header.
+            const auto header_start
+                = static_cast<std::size_t>(line.data() - m_buffer.data());
+            m_buffer.erase(0, header_start);
+            m_scan_offset -= header_start;
+            m_state = SectionState::OpeningBrace;
+            break;
+        }
+        case SectionState::OpeningBrace:
+            if (line != "{") {
+                add_sections(m_buffer);
+            }
+            m_state = SectionState::Body;
+            break;
+        case SectionState::Body:
+            if (line == "}") {
+                add_sections(std::string_view {m_buffer}.substr(
+                    0, m_scan_offset));
+                m_buffer.erase(0, m_scan_offset);
+                m_scan_offset = 0;
+                m_state = SectionState::Header;
+            }
+            break;
+        }
+    }
+}
+
+void SightRead::ChartStreamParser::add_sections(std::string_view text)
+{
+    const auto converter = SightRead::Detail::ChartConverter(m_metadata)
+                               .hopo_threshold(m_hopo_threshold)
+                               .permit_instruments(m_permitted_instruments)
+                               .parse_solos(m_permit_solos);
+    const auto chart
+        = SightRead::Detail::parse_chart(text, m_permitted_instruments);
+    for (const auto& section : chart.sections) {
+        converter.add_section(m_song, section);
+    }
+}
+
+void SightRead::ChartStreamParser::push(std::string_view chunk)
+{
+    m_buffer.append(chunk);
+    if (check_bom(false)) {
+        read_complete_lines();
+    }
+}
+
+SightRead::Song SightRead::ChartStreamParser::finish()
+{
+    check_bom(true);
+    read_complete_lines();
+    // Outside a section, the buffer is only blank lines and a partial line.
+    const auto rest
+        = (m_state == SectionState::Header && !m_is_at_first_line)
+        ? skip_whitespace(m_buffer)
+        : std::string_view {m_buffer};
+    if (!rest.empty()) {
+        add_sections(rest);
+    }
+    return SightRead::Detail::ChartConverter(m_metadata).finish_song(
+        std::move(m_song));
+}
@@ -1,7 +1,18 @@
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
 #include <optional>
+#include <stdexcept>
+#include <utility>
 
 #include "sightread/detail/chart.hpp"
+#include "sightread/detail/parallel.hpp"
+#include "sightread/detail/parserutil.hpp"
 #include "sightread/songparts.hpp"
 
 namespace {
@@ -12,25 +23,51 @@ std::string_view skip_whitespace(std::string_view input)
     return input;
 }
 
-std::string_view break_off_newline(std::string_view& input)
-{
-    if (input.empty()) {
-        throw SightRead::ParseError("No lines left");
+// Reads the lines of a ChartLineIndex in order, skipping blank lines.
+class LineCursor {
+private:
+    const SightRead::Detail::ChartLineIndex& m_index;
+    std::size_t m_next_line {0};
+
+    void skip_blank_lines()
+    {
+        // The first line is never skipped, to match CH's behaviour of
+        // treating an initial blank line as an empty header.
+        while (m_next_line > 0 && m_next_line < m_index.size()
+               && m_index.line(m_next_line).empty()) {
+            ++m_next_line;
+        }
     }
 
-    const auto newline_location
-        = std::min(input.find('\n'), input.find("\r\n"));
-    if (newline_location == std::string_view::npos) {
-        const auto line = input;
-        input.remove_prefix(input.size());
-        return line;
+public:
+    explicit LineCursor(const SightRead::Detail::ChartLineIndex& index,
+                        std::size_t first_line = 0)
+        : m_index {index}
+        , m_next_line {first_line}
+    {
     }
 
-    const auto line = input.substr(0, newline_location);
-    input.remove_prefix(newline_location);
-    input = skip_whitespace(input);
-    return line;
-}
+    // The index of the next line to be read.
+    std::size_t position()
+    {
+        skip_blank_lines();
+        return m_next_line;
+    }
+
+    bool at_end()
+    {
+        skip_blank_lines();
+        return m_next_line >= m_index.size();
+    }
+
+    std::string_view next_line()
+    {
+        if (at_end()) {
+            throw SightRead::ParseError("No lines left");
+        }
+        return m_index.line(m_next_line++);
+    }
+};
 
 std::string_view strip_square_brackets(std::string_view input)
 {
@@ -40,10 +77,70 @@ std::string_view strip_square_brackets(std::string_view input)
     return input.substr(1, input.size() - 2);
 }
 
-// Convert a string_view to an int. If there are any problems with the input,
-// this function returns std::nullopt.
+// Converts exactly eight ASCII characters to the number they represent, or
+// std::nullopt if any of them is not a digit. The checks and conversion are
+// done with SWAR arithmetic on a single 64-bit word rather than per character.
+// The first character must be in the lowest byte, so this is only used on
+// little-endian platforms.
+std::optional<int> parse_eight_digits(std::uint64_t chunk)
+{
+    constexpr std::uint64_t HIGH_NIBBLES = 0xF0F0F0F0F0F0F0F0;
+    constexpr std::uint64_t LOW_NIBBLES = 0x0F0F0F0F0F0F0F0F;
+    constexpr std::uint64_t NINE_TO_FIFTEEN = 0x0606060606060606;
+    constexpr std::uint64_t ALL_THREES = 0x3333333333333333;
+    constexpr std::uint64_t BYTE_PAIR_MASK = 0x00FF00FF00FF00FF;
+    constexpr std::uint64_t SHORT_PAIR_MASK = 0x0000FFFF0000FFFF;
+    constexpr std::uint64_t TEN_TIMES_PLUS_ONE = 2561; // 10 << 8 | 1
+    constexpr std::uint64_t HUNDRED_TIMES_PLUS_ONE = 6553601; // 100 << 16 | 1
+    constexpr std::uint64_t TEN_THOUSAND_TIMES_PLUS_ONE
+        = 42949672960001; // 10000 << 32 | 1
+    constexpr int NIBBLE_BITS = 4;
+    constexpr int BYTE_BITS = 8;
+    constexpr int SHORT_BITS = 16;
+    constexpr int INT_BITS = 32;
+
+    // A byte is a digit if its high nibble is 3 both before and after adding
+    // 6, since that pushes ':' and above into the next nibble.
+    const auto high_nibbles = chunk & HIGH_NIBBLES;
+    const auto shifted_high_nibbles
+        = ((chunk + NINE_TO_FIFTEEN) & HIGH_NIBBLES) >> NIBBLE_BITS;
+    if ((high_nibbles | shifted_high_nibbles) != ALL_THREES) {
+        return std::nullopt;
+    }
+    chunk = ((chunk & LOW_NIBBLES) * TEN_TIMES_PLUS_ONE) >> BYTE_BITS;
+    chunk = ((chunk & BYTE_PAIR_MASK) * HUNDRED_TIMES_PLUS_ONE) >> SHORT_BITS;
+    chunk = ((chunk & SHORT_PAIR_MASK) * TEN_THOUSAND_TIMES_PLUS_ONE)
+        >> INT_BITS;
+    return static_cast<int>(chunk);
+}
+
+// Convert a string_view to an int, accepting the same input as
+// std::from_chars. If there are any problems with the input, this function
+// returns std::nullopt.
 std::optional<int> string_view_to_int(std::string_view input)
 {
+    constexpr std::size_t SWAR_DIGIT_COUNT = 8;
+
+    if constexpr (std::endian::native == std::endian::little) {
+        const bool is_negative = !input.empty() && input.front() == '-';
+        const auto digits = is_negative ? input.substr(1) : input;
+        if (!digits.empty() && digits.size() <= SWAR_DIGIT_COUNT) {
+            // Left pad with zeroes so the digits fill the whole word.
+            std::array<char, SWAR_DIGIT_COUNT> buffer {};
+            buffer.fill('0');
+            const auto padding = SWAR_DIGIT_COUNT - digits.size();
+            std::copy(digits.cbegin(), digits.cend(),
+                      std::next(buffer.begin(),
+                                static_cast<std::ptrdiff_t>(padding)));
+            const auto value
+                = parse_eight_digits(std::bit_cast<std::uint64_t>(buffer));
+            if (!value.has_value() || !is_negative) {
+                return value;
+            }
+            return -*value;
+        }
+    }
+
     int result = 0;
     const char* last = input.data() + input.size();
     auto [p, ec] = std::from_chars(input.data(), last, result);
@@ -53,37 +150,43 @@ std::optional<int> string_view_to_int(std::string_view input)
     return result;
 }
 
-// Split input by space characters, similar to .Split(' ') in C#. Note that
-// the lifetime of the string_views in the output is the same as that of the
-// input.
-std::vector<std::string_view> split_by_space(std::string_view input)
-{
-    std::vector<std::string_view> substrings;
+// The fields of a line split by space characters, similar to .Split(' ') in
+// C#. No event has more than five fields, so only the first five are stored
+// and splitting needs no allocation. Note that the lifetime of the fields is
+// the same as that of the input.
+struct SplitLine {
+    static constexpr std::size_t MAX_FIELDS = 5;
 
-    while (true) {
-        const auto space_location = input.find(' ');
-        if (space_location == std::string_view::npos) {
-            break;
+    std::array<std::string_view, MAX_FIELDS> fields;
+    std::size_t size {0};
+
+    explicit SplitLine(std::string_view input)
+    {
+        while (size + 1 < MAX_FIELDS) {
+            const auto space_location = input.find(' ');
+            if (space_location == std::string_view::npos) {
+                break;
+            }
+            fields.at(size) = input.substr(0, space_location);
+            ++size;
+            input.remove_prefix(space_location + 1);
         }
-        substrings.push_back(input.substr(0, space_location));
-        input.remove_prefix(space_location + 1);
+        const auto space_location = input.find(' ');
+        fields.at(size) = input.substr(0, space_location);
+        ++size;
     }
+};
 
-    substrings.push_back(input);
-    return substrings;
-}
-
-SightRead::Detail::NoteEvent
-convert_line_to_note(int position,
-                     const std::vector<std::string_view>& split_line)
+SightRead::Detail::NoteEvent convert_line_to_note(int position,
+                                                  const SplitLine& split_line)
 {
     constexpr int MAX_NORMAL_EVENT_SIZE = 5;
 
-    if (split_line.size() < MAX_NORMAL_EVENT_SIZE) {
+    if (split_line.size < MAX_NORMAL_EVENT_SIZE) {
         throw SightRead::ParseError("Line incomplete");
     }
-    const auto fret = string_view_to_int(split_line[3]);
-    const auto length = string_view_to_int(split_line[4]);
+    const auto fret = string_view_to_int(split_line.fields[3]);
+    const auto length = string_view_to_int(split_line.fields[4]);
     if (!fret.has_value() || !length.has_value()) {
         throw SightRead::ParseError("Bad note event");
     }
@@ -91,30 +194,28 @@ convert_line_to_note(int position,
 }
 
 SightRead::Detail::SpecialEvent
-convert_line_to_special(int position,
-                        const std::vector<std::string_view>& split_line)
+convert_line_to_special(int position, const SplitLine& split_line)
 {
     constexpr int MAX_NORMAL_EVENT_SIZE = 5;
 
-    if (split_line.size() < MAX_NORMAL_EVENT_SIZE) {
+    if (split_line.size < MAX_NORMAL_EVENT_SIZE) {
         throw SightRead::ParseError("Line incomplete");
     }
-    const auto sp_key = string_view_to_int(split_line[3]);
-    const auto length = string_view_to_int(split_line[4]);
+    const auto sp_key = string_view_to_int(split_line.fields[3]);
+    const auto length = string_view_to_int(split_line.fields[4]);
     if (!sp_key.has_value() || !length.has_value()) {
         throw SightRead::ParseError("Bad SP event");
     }
     return {position, *sp_key, *length};
 }
 
-SightRead::Detail::BpmEvent
-convert_line_to_bpm(int position,
-                    const std::vector<std::string_view>& split_line)
+SightRead::Detail::BpmEvent convert_line_to_bpm(int position,
+                                                const SplitLine& split_line)
 {
-    if (split_line.size() < 4) {
+    if (split_line.size < 4) {
         throw SightRead::ParseError("Line incomplete");
     }
-    const auto bpm = string_view_to_int(split_line[3]);
+    const auto bpm = string_view_to_int(split_line.fields[3]);
     if (!bpm.has_value()) {
         throw SightRead::ParseError("Bad BPM event");
     }
@@ -122,18 +223,17 @@ convert_line_to_bpm(int position,
 }
 
 SightRead::Detail::TimeSigEvent
-convert_line_to_timesig(int position,
-                        const std::vector<std::string_view>& split_line)
+convert_line_to_timesig(int position, const SplitLine& split_line)
 {
     constexpr int MAX_NORMAL_EVENT_SIZE = 5;
 
-    if (split_line.size() < 4) {
+    if (split_line.size < 4) {
         throw SightRead::ParseError("Line incomplete");
     }
-    const auto numer = string_view_to_int(split_line[3]);
+    const auto numer = string_view_to_int(split_line.fields[3]);
     std::optional<int> denom = 2;
-    if (split_line.size() >= MAX_NORMAL_EVENT_SIZE) {
-        denom = string_view_to_int(split_line[4]);
+    if (split_line.size >= MAX_NORMAL_EVENT_SIZE) {
+        denom = string_view_to_int(split_line.fields[4]);
     }
     if (!numer.has_value() || !denom.has_value()) {
         throw SightRead::ParseError("Bad TS event");
@@ -141,73 +241,359 @@ convert_line_to_timesig(int position,
     return {position, *numer, *denom};
 }
 
-SightRead::Detail::Event
-convert_line_to_event(int position,
-                      const std::vector<std::string_view>& split_line)
+SightRead::Detail::Event convert_line_to_event(int position,
+                                               const SplitLine& split_line)
 {
-    if (split_line.size() < 4) {
+    if (split_line.size < 4) {
         throw SightRead::ParseError("Line incomplete");
     }
-    return {position, std::string {split_line[3]}};
+    return {position, split_line.fields[3]};
+}
+
+enum class EventType { Note, Special, Bpm, TimeSig, Event, Unknown };
+
+EventType event_type(std::string_view type)
+{
+    if (type.size() == 1) {
+        switch (type[0]) {
+        case 'N':
+            return EventType::Note;
+        case 'S':
+            return EventType::Special;
+        case 'B':
+            return EventType::Bpm;
+        case 'E':
+            return EventType::Event;
+        default:
+            return EventType::Unknown;
+        }
+    }
+    if (type == "TS") {
+        return EventType::TimeSig;
+    }
+    return EventType::Unknown;
 }
 
-SightRead::Detail::ChartSection read_section(std::string_view& input)
+void add_event(SightRead::Detail::ChartSection& section, int position,
+               const SplitLine& split_line)
 {
-    SightRead::Detail::ChartSection section;
-    section.name = strip_square_brackets(break_off_newline(input));
+    switch (event_type(split_line.fields[2])) {
+    case EventType::Note:
+        section.note_events.push_back(
+            convert_line_to_note(position, split_line));
+        break;
+    case EventType::Special:
+        section.special_events.push_back(
+            convert_line_to_special(position, split_line));
+        break;
+    case EventType::Bpm:
+        section.bpm_events.push_back(convert_line_to_bpm(position, split_line));
+        break;
+    case EventType::TimeSig:
+        section.ts_events.push_back(
+            convert_line_to_timesig(position, split_line));
+        break;
+    case EventType::Event:
+        section.events.push_back(convert_line_to_event(position, split_line));
+        break;
+    case EventType::Unknown:
+        break;
+    }
+}
 
-    if (break_off_newline(input) != "{") {
+// Reads a section header and its opening brace, returning the section name.
+std::string_view read_section_header(LineCursor& lines)
+{
+    const auto name = strip_square_brackets(lines.next_line());
+
+    if (lines.next_line() != "{") {
         throw SightRead::ParseError("Section does not open with {");
     }
 
+    return name;
+}
+
+bool is_permitted_section(
+    std::string_view name,
+    const std::set<SightRead::Instrument>& permitted_instruments)
+{
+    const auto diff_inst = SightRead::Detail::diff_inst_from_header(name);
+    return !diff_inst.has_value()
+        || permitted_instruments.contains(std::get<1>(*diff_inst));
+}
+
+// Moves past the rest of a section without tokenising any of its lines.
+void skip_section_body(LineCursor& lines)
+{
+    auto line = lines.next_line();
+    while (line != "}") {
+        line = lines.next_line();
+    }
+}
+
+SightRead::Detail::ChartSection read_section_body(std::string_view name,
+                                                  LineCursor& lines)
+{
+    SightRead::Detail::ChartSection section;
+    section.name = name;
+    std::vector<std::pair<std::string_view, std::string_view>> key_values;
+
     while (true) {
-        const auto next_line = break_off_newline(input);
+        const auto next_line = lines.next_line();
         if (next_line == "}") {
             break;
         }
-        const auto separated_line = split_by_space(next_line);
-        if (separated_line.size() < 3) {
+        const SplitLine split_line {next_line};
+        if (split_line.size < 3) {
             throw SightRead::ParseError("Line incomplete");
         }
-        const auto key = separated_line[0];
+        const auto key = split_line.fields[0];
         const auto key_val = string_view_to_int(key);
         if (key_val.has_value()) {
-            const auto pos = *key_val;
-            if (separated_line[2] == "N") {
-                section.note_events.push_back(
-                    convert_line_to_note(pos, separated_line));
-            } else if (separated_line[2] == "S") {
-                section.special_events.push_back(
-                    convert_line_to_special(pos, separated_line));
-            } else if (separated_line[2] == "B") {
-                section.bpm_events.push_back(
-                    convert_line_to_bpm(pos, separated_line));
-            } else if (separated_line[2] == "TS") {
-                section.ts_events.push_back(
-                    convert_line_to_timesig(pos, separated_line));
-            } else if (separated_line[2] == "E") {
-                section.events.push_back(
-                    convert_line_to_event(pos, separated_line));
-            }
+            add_event(section, *key_val, split_line);
         } else {
-            std::string value {separated_line[2]};
-            for (auto i = 3U; i < separated_line.size(); ++i) {
-                value.append(separated_line[i]);
-            }
-            section.key_value_pairs[std::string(key)] = value;
+            // The value is the rest of the line from the third field onwards,
+            // less any trailing spaces.
+            const auto value_start = static_cast<std::size_t>(
+                split_line.fields[2].data() - next_line.data());
+            const auto value_end = next_line.find_last_not_of(' ');
+            const auto value_size = value_end < value_start
+                ? 0
+                : value_end + 1 - value_start;
+            key_values.emplace_back(key,
+                                    next_line.substr(value_start, value_size));
         }
     }
 
+    section.key_value_pairs
+        = SightRead::Detail::KeyValuePairs {std::move(key_values)};
     return section;
 }
+
+// Reads a whole section, or skips it and returns std::nullopt if it is for an
+// instrument not in permitted_instruments.
+std::optional<SightRead::Detail::ChartSection>
+read_section(LineCursor& lines,
+             const std::set<SightRead::Instrument>& permitted_instruments)
+{
+    const auto name = read_section_header(lines);
+    if (!is_permitted_section(name, permitted_instruments)) {
+        skip_section_body(lines);
+        return std::nullopt;
+    }
+    return read_section_body(name, lines);
+}
+
+// The line indices [header, end) taken up by a section, including its braces.
+struct SectionLines {
+    std::size_t header;
+    std::size_t end;
+};
+
+// Finds the sections from the cursor onwards, stopping before the first
+// section that does not have both an opening and closing brace. Only the
+// braces are checked, so the sections found may still fail to lex.
+std::vector<SectionLines> find_braced_sections(LineCursor& lines)
+{
+    std::vector<SectionLines> sections;
+
+    while (!lines.at_end()) {
+        const auto header = lines.position();
+        lines.next_line();
+        if (lines.at_end() || lines.next_line() != "{") {
+            break;
+        }
+        auto is_closed = false;
+        while (!is_closed && !lines.at_end()) {
+            is_closed = lines.next_line() == "}";
+        }
+        if (!is_closed) {
+            break;
+        }
+        sections.push_back({header, lines.position()});
+    }
+
+    return sections;
+}
+}
+
+SightRead::Detail::KeyValuePairs::KeyValuePairs(
+    std::vector<std::pair<std::string_view, std::string_view>> pairs)
+    : m_pairs {std::move(pairs)}
+{
+    // The stable sort keeps duplicates in file order, so the last of each run
+    // of equal keys is the one to keep.
+    std::stable_sort(
+        m_pairs.begin(), m_pairs.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    auto output = m_pairs.begin();
+    for (auto p = m_pairs.begin(); p != m_pairs.end(); ++p) {
+        const auto next = std::next(p);
+        if (next == m_pairs.end() || next->first != p->first) {
+            *output++ = *p;
+        }
+    }
+    m_pairs.erase(output, m_pairs.end());
+}
+
+std::optional<std::string_view>
+SightRead::Detail::KeyValuePairs::find(std::string_view key) const
+{
+    const auto pair = std::lower_bound(
+        m_pairs.cbegin(), m_pairs.cend(), key,
+        [](const auto& lhs, std::string_view rhs) { return lhs.first < rhs; });
+    if (pair == m_pairs.cend() || pair->first != key) {
+        return std::nullopt;
+    }
+    return pair->second;
+}
+
+std::string_view
+SightRead::Detail::KeyValuePairs::at(std::string_view key) const
+{
+    const auto value = find(key);
+    if (!value.has_value()) {
+        throw std::out_of_range("Key not present");
+    }
+    return *value;
+}
+
+SightRead::Detail::ChartLineIndex::ChartLineIndex(std::string_view data)
+    : m_data {data}
+{
+    if (data.empty()) {
+        return;
+    }
+    // string_view::find is implemented with memchr, which is vectorised by
+    // the common standard libraries.
+    std::size_t line_start = 0;
+    while (true) {
+        m_line_starts.push_back(line_start);
+        const auto newline_location = data.find('\n', line_start);
+        if (newline_location == std::string_view::npos) {
+            break;
+        }
+        line_start = newline_location + 1;
+    }
+}
+
+std::string_view
+SightRead::Detail::ChartLineIndex::line(std::size_t index) const
+{
+    const auto start = m_line_starts.at(index);
+    auto end = m_data.size();
+    if (index + 1 < m_line_starts.size()) {
+        end = m_line_starts[index + 1] - 1;
+        if (end > start && m_data[end - 1] == '\r') {
+            --end;
+        }
+    }
+    const auto line = m_data.substr(start, end - start);
+    if (index == 0) {
+        return line;
+    }
+    return skip_whitespace(line);
+}
+
+std::size_t
+SightRead::Detail::ChartLineIndex::line_number(std::size_t offset) const
+{
+    const auto next_line = std::upper_bound(m_line_starts.cbegin(),
+                                            m_line_starts.cend(), offset);
+    return static_cast<std::size_t>(
+        std::distance(m_line_starts.cbegin(), next_line));
+}
+
+std::vector<std::size_t>
+SightRead::Detail::ChartLineIndex::section_offsets() const
+{
+    LineCursor lines {*this};
+    const auto sections = find_braced_sections(lines);
+
+    std::vector<std::size_t> offsets;
+    offsets.reserve(sections.size());
+    for (const auto& section : sections) {
+        offsets.push_back(static_cast<std::size_t>(line(section.header).data()
+                                                   - m_data.data()));
+    }
+    return offsets;
+}
+
+SightRead::Detail::ChartLexer::ChartLexer(
+    std::string_view data,
+    std::set<SightRead::Instrument> permitted_instruments,
+    unsigned int thread_count)
+    : m_line_index {data}
+    , m_permitted_instruments {std::move(permitted_instruments)}
+{
+    if (thread_count <= 1) {
+        return;
+    }
+
+    // Errors are held back until next_section reaches the section they came
+    // from, so they surface in the same order as when lexing serially.
+    LineCursor scan {m_line_index};
+    const auto section_lines = find_braced_sections(scan);
+    m_lexed_sections = parallel_map(
+        section_lines.size(), thread_count, [&](std::size_t i) {
+            LexedSection lexed;
+            try {
+                LineCursor lines {m_line_index, section_lines[i].header};
+                lexed.section = read_section(lines, m_permitted_instruments);
+            } catch (...) {
+                lexed.error = std::current_exception();
+            }
+            return lexed;
+        });
+    if (!section_lines.empty()) {
+        m_next_line = section_lines.back().end;
+    }
+}
+
+std::optional<SightRead::Detail::ChartSection>
+SightRead::Detail::ChartLexer::next_section()
+{
+    while (m_next_lexed_section < m_lexed_sections.size()) {
+        auto& lexed = m_lexed_sections[m_next_lexed_section++];
+        if (lexed.error != nullptr) {
+            std::rethrow_exception(lexed.error);
+        }
+        if (lexed.section.has_value()) {
+            return std::move(lexed.section);
+        }
+    }
+
+    // Anything left after a parallel pass is a malformed section, so lexing
+    // it serially throws the same error the serial path would have.
+    LineCursor lines {m_line_index, m_next_line};
+    while (!lines.at_end()) {
+        auto section = read_section(lines, m_permitted_instruments);
+        m_next_line = lines.position();
+        if (section.has_value()) {
+            return section;
+        }
+    }
+    m_next_line = lines.position();
+    return std::nullopt;
 }
 
 SightRead::Detail::Chart SightRead::Detail::parse_chart(std::string_view data)
+{
+    return parse_chart(data, SightRead::all_instruments());
+}
+
+SightRead::Detail::Chart SightRead::Detail::parse_chart(
+    std::string_view data,
+    const std::set<SightRead::Instrument>& permitted_instruments,
+    unsigned int thread_count)
 {
     SightRead::Detail::Chart chart;
+    SightRead::Detail::ChartLexer lexer {data, permitted_instruments,
+                                        thread_count};
 
-    while (!data.empty()) {
-        chart.sections.push_back(read_section(data));
+    for (auto section = lexer.next_section(); section.has_value();
+         section = lexer.next_section()) {
+        chart.sections.push_back(std::move(*section));
     }
 
     return chart;
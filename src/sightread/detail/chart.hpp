@@ -1,12 +1,41 @@
 #ifndef SIGHTREAD_DETAIL_CHART_HPP
 #define SIGHTREAD_DETAIL_CHART_HPP
 
-#include <map>
-#include <string>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <set>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "sightread/songparts.hpp"
+
 namespace SightRead::Detail {
+// Index of the lines in a .chart file, built with a single pass over the
+// input. Lines end at \n, and a \r immediately before the \n is not part of
+// the line; a lone \r does not end a line. Leading whitespace is stripped from
+// every line but the first, matching how the lexer reads them.
+class ChartLineIndex {
+private:
+    std::string_view m_data;
+    std::vector<std::size_t> m_line_starts;
+
+public:
+    explicit ChartLineIndex(std::string_view data);
+    [[nodiscard]] std::size_t size() const { return m_line_starts.size(); }
+    [[nodiscard]] std::string_view line(std::size_t index) const;
+    [[nodiscard]] std::size_t offset(std::size_t index) const
+    {
+        return m_line_starts.at(index);
+    }
+    // Returns the 1-based line number of the byte at the given offset.
+    [[nodiscard]] std::size_t line_number(std::size_t offset) const;
+    // Returns the offsets of the headers of each well-formed section, stopping
+    // at the first section that is not.
+    [[nodiscard]] std::vector<std::size_t> section_offsets() const;
+};
+
 struct BpmEvent {
     int position;
     int bpm;
@@ -14,7 +43,7 @@ struct BpmEvent {
 
 struct Event {
     int position;
-    std::string data;
+    std::string_view data;
 };
 
 struct NoteEvent {
@@ -35,9 +64,31 @@ struct TimeSigEvent {
     int denominator;
 };
 
+// The key/value pairs of a section, kept in a vector sorted by key. If a key
+// appears more than once, only the last value is kept.
+class KeyValuePairs {
+private:
+    std::vector<std::pair<std::string_view, std::string_view>> m_pairs;
+
+public:
+    KeyValuePairs() = default;
+    explicit KeyValuePairs(
+        std::vector<std::pair<std::string_view, std::string_view>> pairs);
+    [[nodiscard]] std::size_t size() const { return m_pairs.size(); }
+    [[nodiscard]] bool empty() const { return m_pairs.empty(); }
+    [[nodiscard]] std::optional<std::string_view>
+    find(std::string_view key) const;
+    // As find, except std::out_of_range is thrown if the key is missing.
+    [[nodiscard]] std::string_view at(std::string_view key) const;
+    [[nodiscard]] auto begin() const { return m_pairs.cbegin(); }
+    [[nodiscard]] auto end() const { return m_pairs.cend(); }
+};
+
+// The string_views in a ChartSection point into the data passed to
+// parse_chart, so the section must not outlive it.
 struct ChartSection {
-    std::string name;
-    std::map<std::string, std::string> key_value_pairs;
+    std::string_view name;
+    KeyValuePairs key_value_pairs;
     std::vector<BpmEvent> bpm_events;
     std::vector<Event> events;
     std::vector<NoteEvent> note_events;
@@ -49,7 +100,39 @@ struct Chart {
     std::vector<ChartSection> sections;
 };
 
+// Lexes a .chart file one section at a time, so each section can be used and
+// dropped before the next is read. Sections for instruments not in
+// permitted_instruments are skipped over without being lexed. If thread_count
+// is more than 1, the sections are instead all lexed up front on up to that
+// many threads; the sections returned and any error thrown are the same.
+class ChartLexer {
+private:
+    struct LexedSection {
+        std::optional<ChartSection> section;
+        std::exception_ptr error;
+    };
+
+    ChartLineIndex m_line_index;
+    std::set<SightRead::Instrument> m_permitted_instruments;
+    std::vector<LexedSection> m_lexed_sections;
+    std::size_t m_next_lexed_section {0};
+    std::size_t m_next_line {0};
+
+public:
+    ChartLexer(std::string_view data,
+               std::set<SightRead::Instrument> permitted_instruments,
+               unsigned int thread_count = 1);
+    // Returns std::nullopt once there are no sections left.
+    std::optional<ChartSection> next_section();
+};
+
 Chart parse_chart(std::string_view data);
+// As parse_chart, except instrument sections for instruments not in
+// permitted_instruments are skipped over without being lexed and are left out
+// of the result. thread_count is as for ChartLexer.
+Chart parse_chart(std::string_view data,
+                  const std::set<SightRead::Instrument>& permitted_instruments,
+                  unsigned int thread_count = 1);
 }
 
 #endif
@@ -1,24 +1,19 @@
 #include <algorithm>
+#include <array>
 #include <climits>
-#include <map>
+#include <cstddef>
+#include <initializer_list>
 #include <optional>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <utility>
 
 #include "sightread/detail/chartconverter.hpp"
+#include "sightread/detail/parallel.hpp"
 #include "sightread/detail/parserutil.hpp"
 
 namespace {
-std::string get_with_default(const std::map<std::string, std::string>& map,
-                             const std::string& key, std::string default_value)
-{
-    const auto iter = map.find(key);
-    if (iter == map.end()) {
-        return default_value;
-    }
-    return iter->second;
-}
-
 SightRead::TempoMap
 tempo_map_from_section(const SightRead::Detail::ChartSection& section,
                        int resolution)
@@ -40,108 +35,94 @@ tempo_map_from_section(const SightRead::Detail::ChartSection& section,
     return {std::move(tses), std::move(bpms), {}, resolution};
 }
 
-std::optional<std::tuple<SightRead::Difficulty, SightRead::Instrument>>
-diff_inst_from_header(const std::string& header)
+constexpr int NO_LANE = -1;
+
+// Builds a table from .chart fret numbers to lanes, with NO_LANE for frets
+// that are not notes.
+template <std::size_t N>
+constexpr std::array<int, N>
+lane_table(std::initializer_list<std::pair<int, int>> fret_lanes)
 {
-    using namespace std::literals;
-
-    constexpr std::array<std::tuple<std::string_view, SightRead::Difficulty>, 4>
-        DIFFICULTIES {std::tuple {"Easy"sv, SightRead::Difficulty::Easy},
-                      {"Medium"sv, SightRead::Difficulty::Medium},
-                      {"Hard"sv, SightRead::Difficulty::Hard},
-                      {"Expert"sv, SightRead::Difficulty::Expert}};
-    constexpr std::array<std::tuple<std::string_view, SightRead::Instrument>,
-                         10>
-        INSTRUMENTS {std::tuple {"Single"sv, SightRead::Instrument::Guitar},
-                     {"DoubleGuitar"sv, SightRead::Instrument::GuitarCoop},
-                     {"DoubleBass"sv, SightRead::Instrument::Bass},
-                     {"DoubleRhythm"sv, SightRead::Instrument::Rhythm},
-                     {"Keyboard"sv, SightRead::Instrument::Keys},
-                     {"GHLGuitar"sv, SightRead::Instrument::GHLGuitar},
-                     {"GHLBass"sv, SightRead::Instrument::GHLBass},
-                     {"GHLRhythm"sv, SightRead::Instrument::GHLRhythm},
-                     {"GHLCoop"sv, SightRead::Instrument::GHLGuitarCoop},
-                     {"Drums"sv, SightRead::Instrument::Drums}};
-    // NOLINT is required because following clang-tidy here causes the VS2017
-    // compile to fail.
-    auto diff_iter = std::find_if( // NOLINT
-        DIFFICULTIES.cbegin(), DIFFICULTIES.cend(), [&](const auto& pair) {
-            return header.starts_with(std::get<0>(pair));
-        });
-    if (diff_iter == DIFFICULTIES.cend()) {
-        return std::nullopt;
-    }
-    auto inst_iter = std::find_if( // NOLINT
-        INSTRUMENTS.cbegin(), INSTRUMENTS.cend(),
-        [&](const auto& pair) { return header.ends_with(std::get<0>(pair)); });
-    if (inst_iter == INSTRUMENTS.cend()) {
-        return std::nullopt;
+    std::array<int, N> lanes {};
+    lanes.fill(NO_LANE);
+    for (const auto& [fret, lane] : fret_lanes) {
+        lanes.at(static_cast<std::size_t>(fret)) = lane;
     }
-    return std::tuple {std::get<1>(*diff_iter), std::get<1>(*inst_iter)};
+    return lanes;
 }
 
-std::optional<SightRead::Note>
-note_from_colour_key_map(const std::map<int, int>& colour_map, int position,
-                         int length, int fret_type, SightRead::NoteFlags flags)
+constexpr auto FIVE_FRET_LANES
+    = lane_table<8>({{0, SightRead::FIVE_FRET_GREEN}, // NOLINT
+                     {1, SightRead::FIVE_FRET_RED},
+                     {2, SightRead::FIVE_FRET_YELLOW},
+                     {3, SightRead::FIVE_FRET_BLUE},
+                     {4, SightRead::FIVE_FRET_ORANGE},
+                     {7, SightRead::FIVE_FRET_OPEN}}); // NOLINT
+
+constexpr auto SIX_FRET_LANES
+    = lane_table<9>({{0, SightRead::SIX_FRET_WHITE_LOW}, // NOLINT
+                     {1, SightRead::SIX_FRET_WHITE_MID},
+                     {2, SightRead::SIX_FRET_WHITE_HIGH},
+                     {3, SightRead::SIX_FRET_BLACK_LOW},
+                     {4, SightRead::SIX_FRET_BLACK_MID},
+                     {7, SightRead::SIX_FRET_OPEN}, // NOLINT
+                     {8, SightRead::SIX_FRET_BLACK_HIGH}}); // NOLINT
+
+constexpr auto DRUM_LANES
+    = lane_table<69>({{0, SightRead::DRUM_KICK}, // NOLINT
+                      {1, SightRead::DRUM_RED},
+                      {2, SightRead::DRUM_YELLOW},
+                      {3, SightRead::DRUM_BLUE},
+                      {4, SightRead::DRUM_GREEN},
+                      {32, SightRead::DRUM_DOUBLE_KICK}, // NOLINT
+                      {66, SightRead::DRUM_YELLOW}, // NOLINT
+                      {67, SightRead::DRUM_BLUE}, // NOLINT
+                      {68, SightRead::DRUM_GREEN}}); // NOLINT
+
+template <std::size_t N>
+int lane_from_table(const std::array<int, N>& lanes, int fret_type)
 {
-    const auto colour_iter = colour_map.find(fret_type);
-    if (colour_iter == colour_map.end()) {
-        return std::nullopt;
+    if (fret_type < 0 || static_cast<std::size_t>(fret_type) >= N) {
+        return NO_LANE;
     }
-    SightRead::Note note;
-    note.position = SightRead::Tick {position};
-    note.lengths.at(colour_iter->second) = SightRead::Tick {length};
-    note.flags = flags;
-    return note;
+    return lanes[static_cast<std::size_t>(fret_type)];
 }
 
 std::optional<SightRead::Note>
 note_from_note_colour(int position, int length, int fret_type,
                       SightRead::TrackType track_type)
 {
-    std::map<int, int> colours;
+    constexpr int CYMBAL_THRESHOLD = 64;
+
+    int lane = NO_LANE;
+    SightRead::NoteFlags flags = SightRead::FLAGS_NONE;
     switch (track_type) {
     case SightRead::TrackType::FiveFret:
-        colours = {{0, SightRead::FIVE_FRET_GREEN},
-                   {1, SightRead::FIVE_FRET_RED},
-                   {2, SightRead::FIVE_FRET_YELLOW},
-                   {3, SightRead::FIVE_FRET_BLUE},
-                   {4, SightRead::FIVE_FRET_ORANGE},
-                   {7, SightRead::FIVE_FRET_OPEN}}; // NOLINT
-        return note_from_colour_key_map(colours, position, length, fret_type,
-                                        SightRead::FLAGS_FIVE_FRET_GUITAR);
+        lane = lane_from_table(FIVE_FRET_LANES, fret_type);
+        flags = SightRead::FLAGS_FIVE_FRET_GUITAR;
+        break;
     case SightRead::TrackType::SixFret:
-        colours = {{0, SightRead::SIX_FRET_WHITE_LOW},
-                   {1, SightRead::SIX_FRET_WHITE_MID},
-                   {2, SightRead::SIX_FRET_WHITE_HIGH},
-                   {3, SightRead::SIX_FRET_BLACK_LOW},
-                   {4, SightRead::SIX_FRET_BLACK_MID},
-                   {7, SightRead::SIX_FRET_OPEN}, // NOLINT
-                   {8, SightRead::SIX_FRET_BLACK_HIGH}}; // NOLINT
-        return note_from_colour_key_map(colours, position, length, fret_type,
-                                        SightRead::FLAGS_SIX_FRET_GUITAR);
-    case SightRead::TrackType::Drums: {
-        constexpr int CYMBAL_THRESHOLD = 64;
-        colours = {{0, SightRead::DRUM_KICK},
-                   {1, SightRead::DRUM_RED},
-                   {2, SightRead::DRUM_YELLOW},
-                   {3, SightRead::DRUM_BLUE},
-                   {4, SightRead::DRUM_GREEN},
-                   {32, SightRead::DRUM_DOUBLE_KICK}, // NOLINT
-                   {66, SightRead::DRUM_YELLOW}, // NOLINT
-                   {67, SightRead::DRUM_BLUE}, // NOLINT
-                   {68, SightRead::DRUM_GREEN}}; // NOLINT
-        auto note = note_from_colour_key_map(colours, position, length,
-                                             fret_type, SightRead::FLAGS_DRUMS);
-        if (note.has_value() && fret_type >= CYMBAL_THRESHOLD) {
-            note->flags = static_cast<SightRead::NoteFlags>(
-                note->flags | SightRead::FLAGS_CYMBAL);
-        }
-        return note;
-    }
+        lane = lane_from_table(SIX_FRET_LANES, fret_type);
+        flags = SightRead::FLAGS_SIX_FRET_GUITAR;
+        break;
+    case SightRead::TrackType::Drums:
+        lane = lane_from_table(DRUM_LANES, fret_type);
+        flags = fret_type >= CYMBAL_THRESHOLD
+            ? static_cast<SightRead::NoteFlags>(SightRead::FLAGS_DRUMS
+                                                | SightRead::FLAGS_CYMBAL)
+            : SightRead::FLAGS_DRUMS;
+        break;
     default:
         throw std::invalid_argument("Invalid track type");
     }
+    if (lane == NO_LANE) {
+        return std::nullopt;
+    }
+    SightRead::Note note;
+    note.position = SightRead::Tick {position};
+    note.lengths.at(static_cast<std::size_t>(lane)) = SightRead::Tick {length};
+    note.flags = flags;
+    return note;
 }
 
 std::vector<SightRead::Note> add_fifth_lane_greens(
@@ -150,12 +131,13 @@ std::vector<SightRead::Note> add_fifth_lane_greens(
 {
     constexpr int FIVE_LANE_GREEN = 5;
 
-    std::set<SightRead::Tick> green_positions;
+    std::vector<SightRead::Tick> green_positions;
     for (const auto& note : notes) {
         if (note.lengths[3] != SightRead::Tick {-1}) {
-            green_positions.insert(note.position);
+            green_positions.push_back(note.position);
         }
     }
+    std::sort(green_positions.begin(), green_positions.end());
     for (const auto& note_event : note_events) {
         if (note_event.fret != FIVE_LANE_GREEN) {
             continue;
@@ -163,7 +145,8 @@ std::vector<SightRead::Note> add_fifth_lane_greens(
         SightRead::Note note;
         note.position = SightRead::Tick {note_event.position};
         note.flags = SightRead::FLAGS_DRUMS;
-        if (green_positions.contains(SightRead::Tick {note_event.position})) {
+        if (std::binary_search(green_positions.cbegin(),
+                               green_positions.cend(), note.position)) {
             note.lengths[SightRead::DRUM_BLUE] = SightRead::Tick {0};
         } else {
             note.lengths[SightRead::DRUM_GREEN] = SightRead::Tick {0};
@@ -173,38 +156,50 @@ std::vector<SightRead::Note> add_fifth_lane_greens(
     return notes;
 }
 
+// A cymbal marker turns the tom it shares a position and colours with into a
+// cymbal, and is dropped if there is no such tom. Within each group of notes
+// sharing a position and colours this means: with no cymbals every note is
+// kept, with one cymbal only the cymbal is kept unless it is alone, and with
+// more than one cymbal the whole group is dropped.
 std::vector<SightRead::Note>
 apply_cymbal_events(const std::vector<SightRead::Note>& notes)
 {
-    std::set<unsigned int> deletion_spots;
+    // Sorting by (position, colours, index) puts each group together.
+    std::vector<std::tuple<SightRead::Tick, int, std::size_t>> sorted_notes;
+    sorted_notes.reserve(notes.size());
     for (auto i = 0U; i < notes.size(); ++i) {
-        const auto& cymbal_note = notes[i];
-        if ((cymbal_note.flags & SightRead::FLAGS_CYMBAL) == 0U) {
-            continue;
-        }
-        bool delete_cymbal = true;
-        for (auto j = 0U; j < notes.size(); ++j) {
-            if (i == j) {
-                continue;
-            }
-            const auto& non_cymbal_note = notes[j];
-            if (non_cymbal_note.position != cymbal_note.position) {
-                continue;
+        sorted_notes.emplace_back(notes[i].position, notes[i].colours(), i);
+    }
+    std::sort(sorted_notes.begin(), sorted_notes.end());
+
+    const auto is_cymbal = [&](const auto& sorted_note) {
+        return (notes[std::get<2>(sorted_note)].flags & SightRead::FLAGS_CYMBAL)
+            != 0U;
+    };
+    std::vector<bool> is_kept(notes.size(), true);
+    auto group_start = sorted_notes.cbegin();
+    while (group_start != sorted_notes.cend()) {
+        const auto group_end = std::find_if(
+            group_start, sorted_notes.cend(), [&](const auto& sorted_note) {
+                return std::get<0>(sorted_note) != std::get<0>(*group_start)
+                    || std::get<1>(sorted_note) != std::get<1>(*group_start);
+            });
+        const auto cymbal_count
+            = std::count_if(group_start, group_end, is_cymbal);
+        if (cymbal_count > 0) {
+            const auto keep_cymbal
+                = cymbal_count == 1 && std::next(group_start) != group_end;
+            for (auto p = group_start; p != group_end; ++p) {
+                is_kept[std::get<2>(*p)] = keep_cymbal && is_cymbal(*p);
             }
-            if (cymbal_note.colours() != non_cymbal_note.colours()) {
-                continue;
-            }
-            delete_cymbal = false;
-            deletion_spots.insert(j);
-        }
-        if (delete_cymbal) {
-            deletion_spots.insert(i);
         }
+        group_start = group_end;
     }
 
     std::vector<SightRead::Note> new_notes;
+    new_notes.reserve(notes.size());
     for (auto i = 0U; i < notes.size(); ++i) {
-        if (!deletion_spots.contains(i)) {
+        if (is_kept[i]) {
             new_notes.push_back(notes[i]);
         }
     }
@@ -236,31 +231,35 @@ std::vector<SightRead::Note> apply_dynamics_events(
     constexpr int ACCENT_BASE = 40;
     constexpr int LANE_COUNT = 4;
 
-    std::set<std::tuple<SightRead::Tick, int>> accent_events;
-    std::set<std::tuple<SightRead::Tick, int>> ghost_events;
+    std::vector<std::tuple<SightRead::Tick, int>> accent_events;
+    std::vector<std::tuple<SightRead::Tick, int>> ghost_events;
 
     for (const auto& event : note_events) {
         if (event.fret > ACCENT_BASE + LANE_COUNT || event.fret < GHOST_BASE) {
             continue;
         }
         if (event.fret < GHOST_BASE + LANE_COUNT) {
-            accent_events.emplace(SightRead::Tick {event.position},
-                                  event.fret - GHOST_BASE);
+            accent_events.emplace_back(SightRead::Tick {event.position},
+                                       event.fret - GHOST_BASE);
         }
         if (event.fret >= ACCENT_BASE) {
-            ghost_events.emplace(SightRead::Tick {event.position},
-                                 event.fret - ACCENT_BASE);
+            ghost_events.emplace_back(SightRead::Tick {event.position},
+                                      event.fret - ACCENT_BASE);
         }
     }
+    std::sort(accent_events.begin(), accent_events.end());
+    std::sort(ghost_events.begin(), ghost_events.end());
     for (auto& note : notes) {
         if (note.is_kick_note()) {
             continue;
         }
-        const auto lane = no_dynamics_lane_colour(note);
-        if (accent_events.contains({note.position, lane})) {
+        const std::tuple key {note.position, no_dynamics_lane_colour(note)};
+        if (std::binary_search(accent_events.cbegin(), accent_events.cend(),
+                               key)) {
             note.flags = static_cast<SightRead::NoteFlags>(
                 note.flags | SightRead::FLAGS_ACCENT);
-        } else if (ghost_events.contains({note.position, lane})) {
+        } else if (std::binary_search(ghost_events.cbegin(),
+                                      ghost_events.cend(), key)) {
             note.flags = static_cast<SightRead::NoteFlags>(
                 note.flags | SightRead::FLAGS_GHOST);
         }
@@ -268,10 +267,12 @@ std::vector<SightRead::Note> apply_dynamics_events(
     return notes;
 }
 
+// Forcing and tap events are gathered in file order and sorted once before
+// being applied.
 class ForcingEvents {
 private:
-    std::set<int> m_forcing_positions;
-    std::set<int> m_tap_positions;
+    std::vector<int> m_forcing_positions;
+    std::vector<int> m_tap_positions;
 
     static bool is_forcing_key(int fret_type, SightRead::TrackType track_type)
     {
@@ -300,13 +301,19 @@ private:
     }
 
 public:
-    void apply_forcing(std::vector<SightRead::Note>& notes) const
+    void apply_forcing(std::vector<SightRead::Note>& notes)
     {
+        std::sort(m_forcing_positions.begin(), m_forcing_positions.end());
+        std::sort(m_tap_positions.begin(), m_tap_positions.end());
         for (auto& note : notes) {
-            if (m_tap_positions.contains(note.position.value())) {
+            const auto position = note.position.value();
+            if (std::binary_search(m_tap_positions.cbegin(),
+                                   m_tap_positions.cend(), position)) {
                 note.flags = static_cast<SightRead::NoteFlags>(
                     note.flags | SightRead::FLAGS_TAP);
-            } else if (m_forcing_positions.contains(note.position.value())) {
+            } else if (std::binary_search(m_forcing_positions.cbegin(),
+                                          m_forcing_positions.cend(),
+                                          position)) {
                 note.flags = static_cast<SightRead::NoteFlags>(
                     note.flags | SightRead::FLAGS_FORCE_FLIP);
             }
@@ -317,9 +324,9 @@ public:
                          SightRead::TrackType track_type)
     {
         if (is_forcing_key(event.fret, track_type)) {
-            m_forcing_positions.insert(event.position);
+            m_forcing_positions.push_back(event.position);
         } else if (is_tap_key(event.fret, track_type)) {
-            m_tap_positions.insert(event.position);
+            m_tap_positions.push_back(event.position);
         }
     }
 };
@@ -352,6 +359,7 @@ note_track_from_section(const SightRead::Detail::ChartSection& section,
 
     ForcingEvents forcing_events;
     std::vector<SightRead::Note> notes;
+    notes.reserve(section.note_events.size());
     for (const auto& note_event : section.note_events) {
         const auto note
             = note_from_note_colour(note_event.position, note_event.length,
@@ -409,7 +417,8 @@ note_track_from_section(const SightRead::Detail::ChartSection& section,
     std::sort(solo_on_events.begin(), solo_on_events.end());
     std::sort(solo_off_events.begin(), solo_off_events.end());
     auto solos = SightRead::Detail::form_solo_vector(
-        solo_on_events, solo_off_events, notes, track_type, false);
+        SightRead::Detail::combine_solo_events(solo_on_events, solo_off_events),
+        notes, track_type, false);
     if (!permit_solos) {
         solos.clear();
     }
@@ -460,6 +469,7 @@ SightRead::Detail::ChartConverter::ChartConverter(SightRead::Metadata metadata)
                         SightRead::Tick {0}}
     , m_permitted_instruments {SightRead::all_instruments()}
     , m_permit_solos {true}
+    , m_worker_threads {1}
 {
 }
 
@@ -486,8 +496,14 @@ SightRead::Detail::ChartConverter::parse_solos(bool permit_solos)
     return *this;
 }
 
-SightRead::Song SightRead::Detail::ChartConverter::convert(
-    const SightRead::Detail::Chart& chart) const
+SightRead::Detail::ChartConverter&
+SightRead::Detail::ChartConverter::worker_threads(unsigned int thread_count)
+{
+    m_worker_threads = thread_count;
+    return *this;
+}
+
+SightRead::Song SightRead::Detail::ChartConverter::new_song() const
 {
     SightRead::Song song;
 
@@ -496,41 +512,134 @@ SightRead::Song SightRead::Detail::ChartConverter::convert(
     song.global_data().artist(m_artist);
     song.global_data().charter(m_charter);
 
-    for (const auto& section : chart.sections) {
-        if (section.name == "Song") {
-            try {
-                const auto resolution = std::stoi(get_with_default(
-                    section.key_value_pairs, "Resolution", "192"));
-                song.global_data().resolution(resolution);
-            } catch (const std::invalid_argument&) {
-                // CH just ignores this kind of parsing mistake.
-                // TODO: Use from_chars instead to avoid having to use
-                // exceptions as control flow.
-            }
-        } else if (section.name == "SyncTrack") {
-            song.global_data().tempo_map(tempo_map_from_section(
-                section, song.global_data().resolution()));
-        } else {
-            auto pair = diff_inst_from_header(section.name);
-            if (!pair.has_value()) {
-                continue;
-            }
-            auto [diff, inst] = *pair;
-            if (!m_permitted_instruments.contains(inst)) {
-                continue;
-            }
-            const auto resolution = song.global_data().resolution();
-            auto note_track = note_track_from_section(
-                section, song.global_data_ptr(),
-                track_type_from_instrument(inst), m_permit_solos,
-                m_hopo_threshold.chart_max_hopo_gap(resolution));
-            song.add_note_track(inst, diff, std::move(note_track));
+    return song;
+}
+
+void SightRead::Detail::ChartConverter::add_section(
+    SightRead::Song& song, const SightRead::Detail::ChartSection& section) const
+{
+    if (section.name == "Song") {
+        try {
+            const auto resolution = std::stoi(std::string {
+                section.key_value_pairs.find("Resolution").value_or("192")});
+            song.global_data().resolution(resolution);
+        } catch (const std::invalid_argument&) {
+            // CH just ignores this kind of parsing mistake.
+            // TODO: Use from_chars instead to avoid having to use
+            // exceptions as control flow.
+        }
+    } else if (section.name == "SyncTrack") {
+        song.global_data().tempo_map(
+            tempo_map_from_section(section, song.global_data().resolution()));
+    } else {
+        auto note_track
+            = convert_note_section(section, song.global_data_ptr());
+        if (note_track.has_value()) {
+            auto& [diff, inst, track] = *note_track;
+            song.add_note_track(inst, diff, std::move(track));
         }
     }
+}
 
+std::optional<std::tuple<SightRead::Difficulty, SightRead::Instrument,
+                         SightRead::NoteTrack>>
+SightRead::Detail::ChartConverter::convert_note_section(
+    const SightRead::Detail::ChartSection& section,
+    const std::shared_ptr<SightRead::SongGlobalData>& global_data) const
+{
+    auto pair = SightRead::Detail::diff_inst_from_header(section.name);
+    if (!pair.has_value()) {
+        return std::nullopt;
+    }
+    auto [diff, inst] = *pair;
+    if (!m_permitted_instruments.contains(inst)) {
+        return std::nullopt;
+    }
+    const auto resolution = global_data->resolution();
+    auto note_track = note_track_from_section(
+        section, global_data, track_type_from_instrument(inst), m_permit_solos,
+        m_hopo_threshold.chart_max_hopo_gap(resolution));
+    return std::tuple {diff, inst, std::move(note_track)};
+}
+
+// The sections only read the global data, so they are converted concurrently
+// and then added to the song in file order, keeping the first track for each
+// instrument and difficulty as add_section does.
+void SightRead::Detail::ChartConverter::add_note_sections(
+    SightRead::Song& song,
+    const std::vector<const SightRead::Detail::ChartSection*>& sections) const
+{
+    const auto global_data = song.global_data_ptr();
+    auto note_tracks = SightRead::Detail::parallel_map(
+        sections.size(), m_worker_threads, [&](std::size_t i) {
+            return convert_note_section(*sections[i], global_data);
+        });
+    for (auto& note_track : note_tracks) {
+        if (note_track.has_value()) {
+            auto& [diff, inst, track] = *note_track;
+            song.add_note_track(inst, diff, std::move(track));
+        }
+    }
+}
+
+SightRead::Song
+SightRead::Detail::ChartConverter::finish_song(SightRead::Song song) const
+{
     if (song.instruments().empty()) {
         throw SightRead::ParseError("Chart has no notes");
     }
 
     return song;
 }
+
+SightRead::Song SightRead::Detail::ChartConverter::convert(
+    const SightRead::Detail::Chart& chart) const
+{
+    auto song = new_song();
+
+    if (m_worker_threads <= 1) {
+        for (const auto& section : chart.sections) {
+            add_section(song, section);
+        }
+        return finish_song(std::move(song));
+    }
+
+    // [Song] and [SyncTrack] change the global data the note sections read,
+    // so the note sections between them are converted in batches to see the
+    // same data as they would in order.
+    std::vector<const SightRead::Detail::ChartSection*> note_sections;
+    for (const auto& section : chart.sections) {
+        if (section.name == "Song" || section.name == "SyncTrack") {
+            add_note_sections(song, note_sections);
+            note_sections.clear();
+            add_section(song, section);
+        } else {
+            note_sections.push_back(&section);
+        }
+    }
+    add_note_sections(song, note_sections);
+
+    return finish_song(std::move(song));
+}
+
+SightRead::Song SightRead::Detail::ChartConverter::convert(
+    SightRead::Detail::ChartLexer& lexer) const
+{
+    if (m_worker_threads > 1) {
+        SightRead::Detail::Chart chart;
+        for (auto section = lexer.next_section(); section.has_value();
+             section = lexer.next_section()) {
+            chart.sections.push_back(std::move(*section));
+        }
+        return convert(chart);
+    }
+
+    auto song = new_song();
+
+    for (auto section = lexer.next_section(); section.has_value();
+         section = lexer.next_section()) {
+        add_section(song, *section);
+    }
+
+    return finish_song(std::move(song));
+}
@@ -1,8 +1,12 @@
 #ifndef SIGHTREAD_DETAIL_CHARTCONVERTER_HPP
 #define SIGHTREAD_DETAIL_CHARTCONVERTER_HPP
 
+#include <memory>
+#include <optional>
 #include <set>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "sightread/detail/chart.hpp"
 #include "sightread/hopothreshold.hpp"
@@ -19,6 +23,19 @@ private:
     SightRead::HopoThreshold m_hopo_threshold;
     std::set<SightRead::Instrument> m_permitted_instruments;
     bool m_permit_solos;
+    unsigned int m_worker_threads;
+
+    // Returns std::nullopt for sections that are not for a permitted
+    // instrument.
+    [[nodiscard]] std::optional<std::tuple<
+        SightRead::Difficulty, SightRead::Instrument, SightRead::NoteTrack>>
+    convert_note_section(
+        const SightRead::Detail::ChartSection& section,
+        const std::shared_ptr<SightRead::SongGlobalData>& global_data) const;
+    void add_note_sections(
+        SightRead::Song& song,
+        const std::vector<const SightRead::Detail::ChartSection*>& sections)
+        const;
 
 public:
     explicit ChartConverter(SightRead::Metadata metadata);
@@ -26,7 +43,22 @@ public:
     ChartConverter&
     permit_instruments(std::set<SightRead::Instrument> permitted_instruments);
     ChartConverter& parse_solos(bool permit_solos);
+    // Sets the number of threads used to convert note sections. The default
+    // of 1 does all the work on the calling thread.
+    ChartConverter& worker_threads(unsigned int thread_count);
     SightRead::Song convert(const SightRead::Detail::Chart& chart) const;
+    // Converts each section as soon as it is lexed, so only one section is
+    // held in memory at a time. With more than one worker thread, every
+    // section is lexed first and then converted as for the Chart overload.
+    SightRead::Song convert(SightRead::Detail::ChartLexer& lexer) const;
+
+    // The steps of convert, for callers that get sections one at a time:
+    // add_section must be called on each section in file order, then
+    // finish_song checks the song has notes.
+    [[nodiscard]] SightRead::Song new_song() const;
+    void add_section(SightRead::Song& song,
+                     const SightRead::Detail::ChartSection& section) const;
+    SightRead::Song finish_song(SightRead::Song song) const;
 };
 }
 
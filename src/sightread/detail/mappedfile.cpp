@@ -0,0 +1,152 @@
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "sightread/detail/mappedfile.hpp"
+
+#ifdef _WIN32
+namespace {
+[[noreturn]] void throw_file_error(const std::filesystem::path& path)
+{
+    throw std::system_error(static_cast<int>(GetLastError()),
+                            std::system_category(),
+                            "Could not map " + path.string());
+}
+
+// Closes a handle when it goes out of scope.
+class HandleCloser {
+private:
+    HANDLE m_handle;
+
+public:
+    explicit HandleCloser(HANDLE handle)
+        : m_handle {handle}
+    {
+    }
+    ~HandleCloser() { CloseHandle(m_handle); }
+    HandleCloser(const HandleCloser&) = delete;
+    HandleCloser& operator=(const HandleCloser&) = delete;
+    HandleCloser(HandleCloser&&) = delete;
+    HandleCloser& operator=(HandleCloser&&) = delete;
+};
+}
+
+SightRead::Detail::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw_file_error(path);
+    }
+    const HandleCloser file_closer {file};
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) == 0) {
+        throw_file_error(path);
+    }
+    if (file_size.QuadPart == 0) {
+        return;
+    }
+
+    // The view keeps the mapping alive, so the mapping handle can be closed
+    // straight away.
+    HANDLE mapping
+        = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        throw_file_error(path);
+    }
+    const HandleCloser mapping_closer {mapping};
+
+    const auto* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        throw_file_error(path);
+    }
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(file_size.QuadPart);
+}
+
+SightRead::Detail::MappedFile::~MappedFile()
+{
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+}
+#else
+namespace {
+[[noreturn]] void throw_file_error(const std::filesystem::path& path)
+{
+    throw std::system_error(errno, std::generic_category(),
+                            "Could not map " + path.string());
+}
+
+// Closes a file descriptor when it goes out of scope.
+class DescriptorCloser {
+private:
+    int m_descriptor;
+
+public:
+    explicit DescriptorCloser(int descriptor)
+        : m_descriptor {descriptor}
+    {
+    }
+    ~DescriptorCloser() { close(m_descriptor); }
+    DescriptorCloser(const DescriptorCloser&) = delete;
+    DescriptorCloser& operator=(const DescriptorCloser&) = delete;
+    DescriptorCloser(DescriptorCloser&&) = delete;
+    DescriptorCloser& operator=(DescriptorCloser&&) = delete;
+};
+}
+
+SightRead::Detail::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT
+    if (descriptor == -1) {
+        throw_file_error(path);
+    }
+    const DescriptorCloser closer {descriptor};
+
+    struct stat file_info {};
+    if (fstat(descriptor, &file_info) == -1) {
+        throw_file_error(path);
+    }
+    if (file_info.st_size == 0) {
+        return;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    const auto size = static_cast<std::size_t>(file_info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (data == MAP_FAILED) { // NOLINT
+        throw_file_error(path);
+    }
+    // The parsers read front to back, so this is only a hint to the kernel and
+    // failure does not matter.
+    madvise(data, size, MADV_SEQUENTIAL);
+    m_data = static_cast<const std::uint8_t*>(data);
+    m_size = size;
+}
+
+SightRead::Detail::MappedFile::~MappedFile()
+{
+    if (m_data != nullptr) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+}
+#endif
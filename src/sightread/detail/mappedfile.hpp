@@ -0,0 +1,32 @@
+#ifndef SIGHTREAD_DETAIL_MAPPEDFILE_HPP
+#define SIGHTREAD_DETAIL_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace SightRead::Detail {
+// A read-only memory mapping of a whole file, unmapped on destruction. Empty
+// files are not mapped and have an empty span.
+class MappedFile {
+private:
+    const std::uint8_t* m_data {nullptr};
+    std::size_t m_size {0};
+
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    [[nodiscard]] std::span<const std::uint8_t> bytes() const
+    {
+        return {m_data, m_size};
+    }
+};
+}
+
+#endif
@@ -1,13 +1,17 @@
+#include <algorithm>
 #include <climits>
 #include <cstddef>
+#include <optional>
+#include <string_view>
 #include <utility>
 
 #include "sightread/songparts.hpp"
 
 #include "midi.hpp"
+#include "parallel.hpp"
 
 namespace {
-void throw_on_insufficient_bytes()
+[[noreturn]] void throw_on_insufficient_bytes()
 {
     throw SightRead::ParseError("insufficient bytes");
 }
@@ -41,6 +45,19 @@ int read_four_byte_be(std::span<const std::uint8_t> span, std::size_t offset)
         | span[offset + 2] << CHAR_BIT | span[offset + 3];
 }
 
+std::array<std::uint8_t, 3> pack_side_index(std::size_t index)
+{
+    constexpr std::size_t MAX_SIDE_INDEX = (1U << (3 * CHAR_BIT)) - 1;
+    constexpr std::size_t BYTE_MASK = 0xFF;
+
+    if (index > MAX_SIDE_INDEX) {
+        throw SightRead::ParseError("Too many meta or sysex events in track");
+    }
+    return {static_cast<std::uint8_t>(index & BYTE_MASK),
+            static_cast<std::uint8_t>((index >> CHAR_BIT) & BYTE_MASK),
+            static_cast<std::uint8_t>((index >> (2 * CHAR_BIT)) & BYTE_MASK)};
+}
+
 struct MidiHeader {
     int ticks_per_quarter_note;
     int num_of_tracks;
@@ -78,20 +95,31 @@ int read_variable_length_num(std::span<const std::uint8_t>& data)
     constexpr int VARIABLE_LENGTH_DATA_MASK = 0x7F;
     constexpr int VARIABLE_LENGTH_DATA_SIZE = 7;
     constexpr int VARIABLE_LENGTH_HIGH_MASK = 0x80;
+    constexpr std::size_t MAX_VARIABLE_LENGTH_SIZE = 4;
 
+    // Most numbers are single byte delta times, so they are handled first.
+    if (!data.empty() && (data[0] & VARIABLE_LENGTH_HIGH_MASK) == 0) {
+        const int number = data[0];
+        data = data.subspan(1);
+        return number;
+    }
+
+    // The bounds check is done once up front rather than per byte.
+    const auto available = std::min(data.size(), MAX_VARIABLE_LENGTH_SIZE);
     int number = 0;
-    int bytes_read = 0;
-    while (!data.empty() && ((data.front() & VARIABLE_LENGTH_HIGH_MASK) != 0)) {
-        ++bytes_read;
-        if (bytes_read >= 4) {
+    for (std::size_t i = 0; i < available; ++i) {
+        const auto byte = data[i];
+        number <<= VARIABLE_LENGTH_DATA_SIZE;
+        number |= byte & VARIABLE_LENGTH_DATA_MASK;
+        if ((byte & VARIABLE_LENGTH_HIGH_MASK) == 0) {
+            data = data.subspan(i + 1);
+            return number;
+        }
+        if (i + 1 == MAX_VARIABLE_LENGTH_SIZE) {
             throw SightRead::ParseError("Too long variable length number");
         }
-        number <<= VARIABLE_LENGTH_DATA_SIZE;
-        number |= pop_front(data) & VARIABLE_LENGTH_DATA_MASK;
     }
-    number <<= VARIABLE_LENGTH_DATA_SIZE;
-    number |= pop_front(data) & VARIABLE_LENGTH_DATA_MASK;
-    return number;
+    throw_on_insufficient_bytes();
 }
 
 SightRead::Detail::MetaEvent
@@ -106,8 +134,7 @@ read_meta_event(std::span<const std::uint8_t>& data)
     if (static_cast<std::size_t>(data_length) > data.size()) {
         throw SightRead::ParseError("Meta Event too long");
     }
-    event.data
-        = std::vector<std::uint8_t> {data.begin(), data.begin() + data_length};
+    event.data = data.subspan(0, static_cast<std::size_t>(data_length));
     data = data.subspan(static_cast<std::size_t>(data_length));
     return event;
 }
@@ -155,19 +182,34 @@ read_sysex_event(std::span<const std::uint8_t>& data)
         throw SightRead::ParseError("Sysex Event too long");
     }
     SightRead::Detail::SysexEvent event;
-    event.data
-        = std::vector<std::uint8_t> {data.begin(), data.begin() + data_length};
+    event.data = data.subspan(0, static_cast<std::size_t>(data_length));
     data = data.subspan(static_cast<std::size_t>(data_length));
     return event;
 }
 
-SightRead::Detail::MidiTrack
-read_midi_track(std::span<const std::uint8_t>& data)
+constexpr int TRACK_HEADER_MAGIC_NUMBER = 0x4D54726B;
+constexpr int TRACK_HEADER_SIZE = 8;
+
+bool is_skipped_track(std::span<const std::uint8_t> name,
+                      const SightRead::Detail::TrackNameFilter& is_track_needed)
+{
+    if (!is_track_needed) {
+        return false;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* name_chars = reinterpret_cast<const char*>(name.data());
+    return !is_track_needed(std::string_view {name_chars, name.size()});
+}
+
+// Returns std::nullopt if the track is skipped by is_track_needed, in which
+// case data is advanced past the track without reading the remaining events.
+std::optional<SightRead::Detail::MidiTrack>
+read_midi_track(std::span<const std::uint8_t>& data,
+                const SightRead::Detail::TrackNameFilter& is_track_needed)
 {
     constexpr int META_EVENT_ID = 0xFF;
     constexpr int SYSEX_EVENT_ID = 0xF0;
-    constexpr int TRACK_HEADER_MAGIC_NUMBER = 0x4D54726B;
-    constexpr int TRACK_HEADER_SIZE = 8;
+    constexpr int TRACK_NAME_ID = 3;
 
     if (read_four_byte_be(data, 0) != TRACK_HEADER_MAGIC_NUMBER) {
         throw SightRead::ParseError("Invalid MIDI file");
@@ -178,39 +220,149 @@ read_midi_track(std::span<const std::uint8_t>& data)
     const auto final_span_size
         = data.size() - static_cast<std::size_t>(track_size);
     auto prev_status_byte = -1;
+    auto has_name = false;
     SightRead::Detail::MidiTrack track;
     while (data.size() != final_span_size) {
         const auto delta_time = read_variable_length_num(data);
         absolute_time += delta_time;
-        SightRead::Detail::TimedEvent event {absolute_time, {}};
         if (data.empty()) {
             throw_on_insufficient_bytes();
         }
         const auto event_type = data.front();
         if (event_type == META_EVENT_ID) {
             data = data.subspan(1);
-            event.event = read_meta_event(data);
+            const auto meta_event = read_meta_event(data);
+            if (!has_name && meta_event.type == TRACK_NAME_ID) {
+                has_name = true;
+                if (data.size() >= final_span_size
+                    && is_skipped_track(meta_event.data, is_track_needed)) {
+                    data = data.subspan(data.size() - final_span_size);
+                    return std::nullopt;
+                }
+            }
+            track.add_event(absolute_time, meta_event);
         } else if (event_type == SYSEX_EVENT_ID) {
             data = data.subspan(1);
-            event.event = read_sysex_event(data);
+            track.add_event(absolute_time, read_sysex_event(data));
         } else {
             const auto midi_event = read_midi_event(data, prev_status_byte);
             prev_status_byte = midi_event.status;
-            event.event = midi_event;
+            track.add_event(absolute_time, midi_event);
         }
-        track.events.push_back(std::move(event));
     }
     return track;
 }
+
+// Returns the offsets of the MTrk chunks the serial loop in parse_midi would
+// read, found from the chunk headers alone. If a header is malformed or its
+// chunk runs past the end of data then that chunk is the last one included, so
+// reading it throws the same error as the serial loop.
+std::vector<std::size_t>
+track_chunk_offsets(std::span<const std::uint8_t> data, int num_of_tracks)
+{
+    std::vector<std::size_t> offsets;
+    std::size_t offset = 0;
+    for (auto i = 0; i < num_of_tracks && offset < data.size(); ++i) {
+        offsets.push_back(offset);
+        const auto remaining = data.size() - offset;
+        if (remaining < TRACK_HEADER_SIZE
+            || read_four_byte_be(data, offset) != TRACK_HEADER_MAGIC_NUMBER) {
+            break;
+        }
+        const auto track_size
+            = static_cast<std::size_t>(read_four_byte_be(data, offset + 4));
+        if (track_size > remaining - TRACK_HEADER_SIZE) {
+            break;
+        }
+        offset += TRACK_HEADER_SIZE + track_size;
+    }
+    return offsets;
+}
+}
+
+SightRead::Detail::MidiTrack::MidiTrack(
+    const std::vector<SightRead::Detail::TimedEvent>& timed_events)
+{
+    events.reserve(timed_events.size());
+    for (const auto& event : timed_events) {
+        std::visit([&](const auto& e) { add_event(event.time, e); },
+                   event.event);
+    }
+}
+
+void SightRead::Detail::MidiTrack::add_event(
+    int time, const SightRead::Detail::MetaEvent& event)
+{
+    events.push_back({time, PackedEvent::META_STATUS,
+                      pack_side_index(meta_events.size())});
+    meta_events.push_back(event);
+}
+
+void SightRead::Detail::MidiTrack::add_event(
+    int time, const SightRead::Detail::MidiEvent& event)
+{
+    events.push_back({time, static_cast<std::uint8_t>(event.status),
+                      {event.data[0], event.data[1], 0}});
+}
+
+void SightRead::Detail::MidiTrack::add_event(
+    int time, const SightRead::Detail::SysexEvent& event)
+{
+    events.push_back({time, PackedEvent::SYSEX_STATUS,
+                      pack_side_index(sysex_events.size())});
+    sysex_events.push_back(event);
+}
+
+SightRead::Detail::TimedEvent SightRead::Detail::MidiTrack::unpack(
+    const SightRead::Detail::PackedEvent& event) const
+{
+    switch (event.status) {
+    case PackedEvent::META_STATUS:
+        return {event.time, meta_events.at(event.side_index())};
+    case PackedEvent::SYSEX_STATUS:
+        return {event.time, sysex_events.at(event.side_index())};
+    default:
+        return {event.time,
+                SightRead::Detail::MidiEvent {event.status,
+                                              {event.data[0], event.data[1]}}};
+    }
 }
 
 SightRead::Detail::Midi
-SightRead::Detail::parse_midi(std::span<const std::uint8_t> data)
+SightRead::Detail::parse_midi(std::span<const std::uint8_t> data,
+                              unsigned int thread_count,
+                              const SightRead::Detail::TrackNameFilter&
+                                  is_track_needed)
 {
+    const SightRead::Detail::TrackNameFilter no_filter;
+    const auto& filter_for_track = [&](std::size_t index) -> const auto& {
+        return index == 0 ? no_filter : is_track_needed;
+    };
+
     const auto header = read_midi_header(data);
     std::vector<SightRead::Detail::MidiTrack> tracks;
-    for (auto i = 0; i < header.num_of_tracks && !data.empty(); ++i) {
-        tracks.push_back(read_midi_track(data));
+    if (thread_count > 1) {
+        const auto offsets = track_chunk_offsets(data, header.num_of_tracks);
+        // Each chunk is read with the rest of the file after it, so a chunk
+        // whose events overrun its length fails exactly as it would serially.
+        auto read_tracks = SightRead::Detail::parallel_map(
+            offsets.size(), thread_count, [&](std::size_t i) {
+                auto track_data = data.subspan(offsets[i]);
+                return read_midi_track(track_data, filter_for_track(i));
+            });
+        for (auto& track : read_tracks) {
+            if (track.has_value()) {
+                tracks.push_back(std::move(*track));
+            }
+        }
+    } else {
+        for (auto i = 0; i < header.num_of_tracks && !data.empty(); ++i) {
+            auto track = read_midi_track(
+                data, filter_for_track(static_cast<std::size_t>(i)));
+            if (track.has_value()) {
+                tracks.push_back(std::move(*track));
+            }
+        }
     }
     return SightRead::Detail::Midi {header.ticks_per_quarter_note,
                                     std::move(tracks)};
@@ -2,15 +2,21 @@
 #define SIGHTREAD_DETAIL_MIDI_HPP
 
 #include <array>
+#include <climits>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <span>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 namespace SightRead::Detail {
+// The data of meta and sysex events views the buffer passed to parse_midi
+// rather than owning a copy.
 struct MetaEvent {
     int type;
-    std::vector<std::uint8_t> data;
+    std::span<const std::uint8_t> data;
 };
 
 struct MidiEvent {
@@ -19,7 +25,7 @@ struct MidiEvent {
 };
 
 struct SysexEvent {
-    std::vector<std::uint8_t> data;
+    std::span<const std::uint8_t> data;
 };
 
 struct TimedEvent {
@@ -27,8 +33,39 @@ struct TimedEvent {
     std::variant<MetaEvent, MidiEvent, SysexEvent> event;
 };
 
+// An event as stored in a MidiTrack, packed into 8 bytes. Channel events keep
+// their status and data bytes inline; meta and sysex events have status
+// META_STATUS or SYSEX_STATUS and data holds the little endian index of the
+// event in the track's meta_events or sysex_events.
+struct PackedEvent {
+    static constexpr std::uint8_t META_STATUS = 0xFF;
+    static constexpr std::uint8_t SYSEX_STATUS = 0xF0;
+
+    int time {0};
+    std::uint8_t status {0};
+    std::array<std::uint8_t, 3> data {};
+
+    [[nodiscard]] std::size_t side_index() const
+    {
+        return static_cast<std::size_t>(data[0] | data[1] << CHAR_BIT
+                                        | data[2] << (2 * CHAR_BIT));
+    }
+};
+
+static_assert(sizeof(PackedEvent) == 8);
+
 struct MidiTrack {
-    std::vector<TimedEvent> events;
+    std::vector<PackedEvent> events;
+    std::vector<MetaEvent> meta_events;
+    std::vector<SysexEvent> sysex_events;
+
+    MidiTrack() = default;
+    explicit MidiTrack(const std::vector<TimedEvent>& timed_events);
+
+    void add_event(int time, const MetaEvent& event);
+    void add_event(int time, const MidiEvent& event);
+    void add_event(int time, const SysexEvent& event);
+    [[nodiscard]] TimedEvent unpack(const PackedEvent& event) const;
 };
 
 struct Midi {
@@ -36,7 +73,19 @@ struct Midi {
     std::vector<MidiTrack> tracks;
 };
 
-Midi parse_midi(std::span<const std::uint8_t> data);
+// Decides from a track's name whether parse_midi should decode the rest of
+// the track.
+using TrackNameFilter = std::function<bool(std::string_view)>;
+
+// The returned Midi refers into data, so data must outlive it. If thread_count
+// is more than 1, track chunks are decoded concurrently on up to that many
+// threads, with the same result or exception as decoding them in order.
+// If is_track_needed is set, tracks after the first whose name it rejects are
+// skipped once their name is read and left out of the result; the events of a
+// skipped track are not validated.
+Midi parse_midi(std::span<const std::uint8_t> data,
+                unsigned int thread_count = 1,
+                const TrackNameFilter& is_track_needed = {});
 }
 
 #endif
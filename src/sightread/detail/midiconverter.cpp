@@ -1,12 +1,17 @@
 #include <algorithm>
 #include <climits>
+#include <iterator>
 #include <limits>
 #include <optional>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "sightread/detail/midiconverter.hpp"
+#include "sightread/detail/parallel.hpp"
 #include "sightread/detail/parserutil.hpp"
+#include "sightread/detail/perfecthash.hpp"
 
 namespace {
 SightRead::TempoMap
@@ -18,33 +23,32 @@ read_first_midi_track(const SightRead::Detail::MidiTrack& track, int resolution)
     std::vector<SightRead::BPM> tempos;
     std::vector<SightRead::TimeSignature> time_sigs;
     for (const auto& event : track.events) {
-        const auto* meta_event
-            = std::get_if<SightRead::Detail::MetaEvent>(&event.event);
-        if (meta_event == nullptr) {
+        if (event.status != SightRead::Detail::PackedEvent::META_STATUS) {
             continue;
         }
-        switch (meta_event->type) {
+        const auto& meta_event = track.meta_events[event.side_index()];
+        switch (meta_event.type) {
         case SET_TEMPO_ID: {
-            if (meta_event->data.size() < 3) {
+            if (meta_event.data.size() < 3) {
                 throw SightRead::ParseError("Tempo meta event too short");
             }
-            const auto us_per_quarter = meta_event->data[0] << 16
-                | meta_event->data[1] << 8 | meta_event->data[2];
+            const auto us_per_quarter = meta_event.data[0] << 16
+                | meta_event.data[1] << 8 | meta_event.data[2];
             const auto bpm = 60000000000 / us_per_quarter;
             tempos.push_back(
                 {SightRead::Tick {event.time}, static_cast<int>(bpm)});
             break;
         }
         case TIME_SIG_ID:
-            if (meta_event->data.size() < 2) {
+            if (meta_event.data.size() < 2) {
                 throw SightRead::ParseError("Tempo meta event too short");
             }
-            if (meta_event->data[1] >= (CHAR_BIT * sizeof(int))) {
+            if (meta_event.data[1] >= (CHAR_BIT * sizeof(int))) {
                 throw SightRead::ParseError("Time sig denominator too large");
             }
             time_sigs.push_back({SightRead::Tick {event.time},
-                                 meta_event->data[0],
-                                 1 << meta_event->data[1]});
+                                 meta_event.data[0],
+                                 1 << meta_event.data[1]});
             break;
         }
     }
@@ -55,19 +59,11 @@ read_first_midi_track(const SightRead::Detail::MidiTrack& track, int resolution)
 std::optional<std::string>
 midi_track_name(const SightRead::Detail::MidiTrack& track)
 {
-    if (track.events.empty()) {
-        return std::nullopt;
-    }
-    for (const auto& event : track.events) {
-        const auto* meta_event
-            = std::get_if<SightRead::Detail::MetaEvent>(&event.event);
-        if (meta_event == nullptr) {
+    for (const auto& meta_event : track.meta_events) {
+        if (meta_event.type != 3) {
             continue;
         }
-        if (meta_event->type != 3) {
-            continue;
-        }
-        return std::string {meta_event->data.cbegin(), meta_event->data.cend()};
+        return std::string {meta_event.data.begin(), meta_event.data.end()};
     }
     return std::nullopt;
 }
@@ -83,18 +79,13 @@ od_beats_from_track(const SightRead::Detail::MidiTrack& track)
     std::vector<SightRead::Tick> od_beats;
 
     for (const auto& event : track.events) {
-        const auto* midi_event
-            = std::get_if<SightRead::Detail::MidiEvent>(&event.event);
-        if (midi_event == nullptr) {
+        if ((event.status & UPPER_NIBBLE_MASK) != NOTE_ON_ID) {
             continue;
         }
-        if ((midi_event->status & UPPER_NIBBLE_MASK) != NOTE_ON_ID) {
+        if (event.data[1] == 0) {
             continue;
         }
-        if (midi_event->data[1] == 0) {
-            continue;
-        }
-        const auto key = midi_event->data[0];
+        const auto key = event.data[0];
         if (key == BEAT_LOW_KEY || key == BEAT_HIGH_KEY) {
             od_beats.emplace_back(event.time);
         }
@@ -104,80 +95,41 @@ od_beats_from_track(const SightRead::Detail::MidiTrack& track)
 }
 
 std::optional<SightRead::Instrument>
-midi_section_instrument(const std::string& track_name)
+midi_section_instrument(std::string_view track_name)
 {
-    const std::map<std::string, SightRead::Instrument> INSTRUMENTS {
-        {"PART GUITAR", SightRead::Instrument::Guitar},
-        {"T1 GEMS", SightRead::Instrument::Guitar},
-        {"PART GUITAR COOP", SightRead::Instrument::GuitarCoop},
-        {"PART BASS", SightRead::Instrument::Bass},
-        {"PART RHYTHM", SightRead::Instrument::Rhythm},
-        {"PART KEYS", SightRead::Instrument::Keys},
-        {"PART GUITAR GHL", SightRead::Instrument::GHLGuitar},
-        {"PART BASS GHL", SightRead::Instrument::GHLBass},
-        {"PART RHYTHM GHL", SightRead::Instrument::GHLRhythm},
-        {"PART GUITAR COOP GHL", SightRead::Instrument::GHLGuitarCoop},
-        {"PART DRUMS", SightRead::Instrument::Drums}};
-
-    const auto iter = INSTRUMENTS.find(track_name);
-    if (iter == INSTRUMENTS.end()) {
-        return std::nullopt;
-    }
-    return iter->second;
-}
-
-bool is_five_lane_green_note(const SightRead::Detail::TimedEvent& event)
-{
-    constexpr std::array<std::uint8_t, 4> GREEN_LANE_KEYS {65, 77, 89, 101};
-    constexpr int NOTE_OFF_ID = 0x80;
-    constexpr int NOTE_ON_ID = 0x90;
-    constexpr int UPPER_NIBBLE_MASK = 0xF0;
-
-    const auto* midi_event
-        = std::get_if<SightRead::Detail::MidiEvent>(&event.event);
-    if (midi_event == nullptr) {
-        return false;
-    }
-    const auto event_type = midi_event->status & UPPER_NIBBLE_MASK;
-    if (event_type != NOTE_ON_ID && event_type != NOTE_OFF_ID) {
-        return false;
-    }
-    const auto key = midi_event->data[0];
-    return std::find(GREEN_LANE_KEYS.cbegin(), GREEN_LANE_KEYS.cend(), key)
-        != GREEN_LANE_KEYS.cend();
-}
+    using namespace std::literals;
 
-bool has_five_lane_green_notes(const SightRead::Detail::MidiTrack& midi_track)
-{
-    return std::find_if(midi_track.events.cbegin(), midi_track.events.cend(),
-                        is_five_lane_green_note)
-        != midi_track.events.cend();
+    constexpr std::size_t TABLE_SIZE = 64;
+    constexpr SightRead::Detail::PerfectHashMap<SightRead::Instrument, 11,
+                                                TABLE_SIZE>
+        INSTRUMENTS {{
+            std::tuple {"PART GUITAR"sv, SightRead::Instrument::Guitar},
+            {"T1 GEMS"sv, SightRead::Instrument::Guitar},
+            {"PART GUITAR COOP"sv, SightRead::Instrument::GuitarCoop},
+            {"PART BASS"sv, SightRead::Instrument::Bass},
+            {"PART RHYTHM"sv, SightRead::Instrument::Rhythm},
+            {"PART KEYS"sv, SightRead::Instrument::Keys},
+            {"PART GUITAR GHL"sv, SightRead::Instrument::GHLGuitar},
+            {"PART BASS GHL"sv, SightRead::Instrument::GHLBass},
+            {"PART RHYTHM GHL"sv, SightRead::Instrument::GHLRhythm},
+            {"PART GUITAR COOP GHL"sv, SightRead::Instrument::GHLGuitarCoop},
+            {"PART DRUMS"sv, SightRead::Instrument::Drums}}};
+
+    return INSTRUMENTS.find(track_name);
 }
 
-bool is_enable_chart_dynamics(const SightRead::Detail::TimedEvent& event)
+bool is_enable_chart_dynamics(const SightRead::Detail::MetaEvent& event)
 {
     using namespace std::literals;
     constexpr auto ENABLE_DYNAMICS = "[ENABLE_CHART_DYNAMICS]"sv;
 
-    const auto* meta_event
-        = std::get_if<SightRead::Detail::MetaEvent>(&event.event);
-    if (meta_event == nullptr) {
+    if (event.type != 1) {
         return false;
     }
-    if (meta_event->type != 1) {
-        return false;
-    }
-    return std::equal(meta_event->data.cbegin(), meta_event->data.cend(),
+    return std::equal(event.data.begin(), event.data.end(),
                       ENABLE_DYNAMICS.cbegin(), ENABLE_DYNAMICS.cend());
 }
 
-bool has_enable_chart_dynamics(const SightRead::Detail::MidiTrack& midi_track)
-{
-    return std::find_if(midi_track.events.cbegin(), midi_track.events.cend(),
-                        is_enable_chart_dynamics)
-        != midi_track.events.cend();
-}
-
 bool is_open_event_sysex(const SightRead::Detail::SysexEvent& event)
 {
     constexpr std::array<std::tuple<std::size_t, int>, 6> REQUIRED_BYTES {
@@ -202,105 +154,6 @@ bool is_open_event_sysex(const SightRead::Detail::SysexEvent& event)
         });
 }
 
-std::optional<SightRead::Difficulty>
-look_up_difficulty(const std::array<std::tuple<int, int, SightRead::Difficulty>,
-                                    4>& diff_ranges,
-                   std::uint8_t key)
-{
-    for (const auto& [min, max, diff] : diff_ranges) {
-        if (key >= min && key <= max) {
-            return {diff};
-        }
-    }
-
-    return std::nullopt;
-}
-
-std::optional<SightRead::Difficulty>
-difficulty_from_key(std::uint8_t key, SightRead::TrackType track_type)
-{
-    std::array<std::tuple<int, int, SightRead::Difficulty>, 4> diff_ranges;
-    switch (track_type) {
-    case SightRead::TrackType::FiveFret:
-        diff_ranges = {{{96, 102, SightRead::Difficulty::Expert}, // NOLINT
-                        {84, 90, SightRead::Difficulty::Hard}, // NOLINT
-                        {72, 78, SightRead::Difficulty::Medium}, // NOLINT
-                        {60, 66, SightRead::Difficulty::Easy}}}; // NOLINT
-        break;
-    case SightRead::TrackType::SixFret:
-        diff_ranges = {{{94, 102, SightRead::Difficulty::Expert}, // NOLINT
-                        {82, 90, SightRead::Difficulty::Hard}, // NOLINT
-                        {70, 78, SightRead::Difficulty::Medium}, // NOLINT
-                        {58, 66, SightRead::Difficulty::Easy}}}; // NOLINT
-        break;
-    case SightRead::TrackType::Drums:
-        diff_ranges = {{{95, 101, SightRead::Difficulty::Expert}, // NOLINT
-                        {83, 89, SightRead::Difficulty::Hard}, // NOLINT
-                        {71, 77, SightRead::Difficulty::Medium}, // NOLINT
-                        {59, 65, SightRead::Difficulty::Easy}}}; // NOLINT
-        break;
-    }
-    return look_up_difficulty(diff_ranges, key);
-}
-
-template <typename T, std::size_t N>
-T colour_from_key_and_bounds(std::uint8_t key,
-                             const std::array<unsigned int, 4>& diff_ranges,
-                             const std::array<T, N>& colours)
-{
-    for (auto min : diff_ranges) {
-        if (key >= min && (key - min) < colours.size()) {
-            return colours.at(key - min);
-        }
-    }
-
-    throw SightRead::ParseError("Invalid key for note");
-}
-
-int colour_from_key(std::uint8_t key, SightRead::TrackType track_type,
-                    bool from_five_lane)
-{
-    std::array<unsigned int, 4> diff_ranges {};
-    switch (track_type) {
-    case SightRead::TrackType::FiveFret: {
-        diff_ranges = {96, 84, 72, 60}; // NOLINT
-        constexpr std::array NOTE_COLOURS {
-            SightRead::FIVE_FRET_GREEN, SightRead::FIVE_FRET_RED,
-            SightRead::FIVE_FRET_YELLOW, SightRead::FIVE_FRET_BLUE,
-            SightRead::FIVE_FRET_ORANGE};
-        return colour_from_key_and_bounds(key, diff_ranges, NOTE_COLOURS);
-    }
-    case SightRead::TrackType::SixFret: {
-        diff_ranges = {94, 82, 70, 58}; // NOLINT
-        constexpr std::array GHL_NOTE_COLOURS {
-            SightRead::SIX_FRET_OPEN,      SightRead::SIX_FRET_WHITE_LOW,
-            SightRead::SIX_FRET_WHITE_MID, SightRead::SIX_FRET_WHITE_HIGH,
-            SightRead::SIX_FRET_BLACK_LOW, SightRead::SIX_FRET_BLACK_MID,
-            SightRead::SIX_FRET_BLACK_HIGH};
-        return colour_from_key_and_bounds(key, diff_ranges, GHL_NOTE_COLOURS);
-    }
-    case SightRead::TrackType::Drums: {
-        diff_ranges = {95, 83, 71, 59}; // NOLINT
-        constexpr std::array DRUM_NOTE_COLOURS {
-            SightRead::DRUM_DOUBLE_KICK, SightRead::DRUM_KICK,
-            SightRead::DRUM_RED,         SightRead::DRUM_YELLOW,
-            SightRead::DRUM_BLUE,        SightRead::DRUM_GREEN};
-        constexpr std::array FIVE_LANE_COLOURS {
-            SightRead::DRUM_DOUBLE_KICK, SightRead::DRUM_KICK,
-            SightRead::DRUM_RED,         SightRead::DRUM_YELLOW,
-            SightRead::DRUM_BLUE,        SightRead::DRUM_GREEN,
-            SightRead::DRUM_GREEN};
-        if (from_five_lane) {
-            return colour_from_key_and_bounds(key, diff_ranges,
-                                              FIVE_LANE_COLOURS);
-        }
-        return colour_from_key_and_bounds(key, diff_ranges, DRUM_NOTE_COLOURS);
-    }
-    default:
-        throw std::invalid_argument("Invalid track type");
-    }
-}
-
 SightRead::NoteFlags flags_from_track_type(SightRead::TrackType track_type)
 {
     switch (track_type) {
@@ -315,12 +168,11 @@ SightRead::NoteFlags flags_from_track_type(SightRead::TrackType track_type)
     }
 }
 
-bool is_cymbal_key(std::uint8_t key, bool from_five_lane)
+// In five lane tracks the blue pad is never a cymbal; that is fixed up by
+// resolve_drum_flags once the whole track has been read.
+constexpr bool is_cymbal_key(int key)
 {
     const auto index = (key + 1) % 12;
-    if (from_five_lane) {
-        return index == 3 || index == 5; // NOLINT
-    }
     return index == 3 || index == 4 || index == 5; // NOLINT
 }
 
@@ -337,102 +189,213 @@ SightRead::NoteFlags dynamics_flags_from_velocity(std::uint8_t velocity)
     return static_cast<SightRead::NoteFlags>(0);
 }
 
-// Like combine_solo_events, but never skips on events to suit Midi parsing and
-// checks if there is an unmatched on event.
-// The tuples are a pair of the form (position, rank), where events later in the
-// file have a higher rank. This is in case of the Note Off event being right
-// after the corresponding Note On event in the file, but at the same tick.
-std::vector<std::tuple<int, int>>
-combine_note_on_off_events(const std::vector<std::tuple<int, int>>& on_events,
-                           const std::vector<std::tuple<int, int>>& off_events)
+constexpr std::size_t DIFFICULTY_COUNT = 4;
+constexpr std::size_t MAX_COLOUR_COUNT = 7;
+// Drum Note Ons can carry the cymbal flag and at most one of the ghost and
+// accent flags. These are the lowest three NoteFlags bits, so the flags masked
+// to them index the Note On lists directly.
+constexpr std::size_t NOTE_FLAG_VARIANT_COUNT = 6;
+constexpr auto NOTE_VARIANT_FLAGS = SightRead::FLAGS_CYMBAL
+    | SightRead::FLAGS_GHOST | SightRead::FLAGS_ACCENT;
+
+using EventSpanList = std::vector<std::tuple<int, int>>;
+template <typename T> using PerDifficulty = std::array<T, DIFFICULTY_COUNT>;
+template <typename T> using PerColour = std::array<T, MAX_COLOUR_COUNT>;
+
+std::size_t difficulty_index(SightRead::Difficulty diff)
+{
+    return static_cast<std::size_t>(diff);
+}
+
+std::size_t flag_variant_index(SightRead::NoteFlags flags)
 {
-    std::vector<std::tuple<int, int>> ranges;
+    return flags & NOTE_VARIANT_FLAGS;
+}
 
-    auto on_iter = on_events.cbegin();
-    auto off_iter = off_events.cbegin();
+// Pairs up the Note On and Off events of a key as the track is read. A Note
+// Off ends the earliest unpaired Note On before it in the file, and is ignored
+// if there is none. This means a Note Off right after its Note On in the file
+// but at the same tick still ends it.
+class EventSpans {
+private:
+    EventSpanList m_spans;
+    std::vector<int> m_unpaired_ons;
+    std::size_t m_first_unpaired {0};
+    bool m_has_on_events {false};
+    bool m_has_off_events {false};
 
-    while (on_iter < on_events.cend() && off_iter < off_events.cend()) {
-        if (*on_iter >= *off_iter) {
-            ++off_iter;
-            continue;
+public:
+    void add_on(int time)
+    {
+        m_has_on_events = true;
+        m_unpaired_ons.push_back(time);
+    }
+
+    void add_off(int time)
+    {
+        m_has_off_events = true;
+        if (m_first_unpaired == m_unpaired_ons.size()) {
+            return;
         }
-        ranges.emplace_back(std::get<0>(*on_iter), std::get<0>(*off_iter));
-        ++on_iter;
-        ++off_iter;
+        m_spans.emplace_back(m_unpaired_ons[m_first_unpaired], time);
+        ++m_first_unpaired;
+        if (m_first_unpaired == m_unpaired_ons.size()) {
+            m_unpaired_ons.clear();
+            m_first_unpaired = 0;
+        }
+    }
+
+    [[nodiscard]] bool has_on_events() const { return m_has_on_events; }
+    [[nodiscard]] bool has_off_events() const { return m_has_off_events; }
+    [[nodiscard]] std::size_t on_event_count() const
+    {
+        return m_spans.size() + m_unpaired_ons.size() - m_first_unpaired;
     }
 
-    if (on_iter != on_events.cend()) {
-        throw SightRead::ParseError("on event has no corresponding off event");
+    // The (start, end) spans have non-decreasing starts and ends.
+    [[nodiscard]] const EventSpanList& spans() const
+    {
+        if (m_first_unpaired != m_unpaired_ons.size()) {
+            throw SightRead::ParseError(
+                "on event has no corresponding off event");
+        }
+        return m_spans;
     }
+};
+
+// The ways resolve_drum_flags can settle a drum Note On's flags: dropping the
+// cymbal flag (blue pads in five lane tracks) and dropping the dynamics flags.
+constexpr std::size_t DROP_CYMBAL = 1U << 0U;
+constexpr std::size_t DROP_DYNAMICS = 1U << 1U;
+constexpr std::size_t DRUM_FLAG_RESOLUTION_COUNT = 4;
 
-    return ranges;
+std::size_t resolve_flag_variant(std::size_t variant, std::size_t resolution)
+{
+    if ((resolution & DROP_CYMBAL) != 0) {
+        variant &= ~std::size_t {SightRead::FLAGS_CYMBAL};
+    }
+    if ((resolution & DROP_DYNAMICS) != 0) {
+        variant &= ~std::size_t {SightRead::FLAGS_GHOST
+                                 | SightRead::FLAGS_ACCENT};
+    }
+    return variant;
 }
 
+// The Note Ons of one drum pad, split by their flags. Note Ons whose flags end
+// up the same pair with the pad's Note Offs together, and which flags those
+// are is only known once the whole track is read. So the count of unpaired
+// Note Ons is kept for every way the flags can be resolved. Drum notes have no
+// length, so only the Note On positions are stored.
+class DrumPadEvents {
+private:
+    std::array<std::vector<int>, NOTE_FLAG_VARIANT_COUNT> m_note_ons;
+    std::array<std::array<int, NOTE_FLAG_VARIANT_COUNT>,
+               DRUM_FLAG_RESOLUTION_COUNT>
+        m_unpaired_counts {};
+    std::size_t m_resolution {0};
+    bool m_has_off_events {false};
+
+public:
+    void add_on(int time, std::size_t variant)
+    {
+        m_note_ons.at(variant).push_back(time);
+        for (auto r = 0U; r < DRUM_FLAG_RESOLUTION_COUNT; ++r) {
+            ++m_unpaired_counts.at(r).at(resolve_flag_variant(variant, r));
+        }
+    }
+
+    void add_off()
+    {
+        m_has_off_events = true;
+        for (auto& counts : m_unpaired_counts) {
+            for (auto& count : counts) {
+                count = std::max(count - 1, 0);
+            }
+        }
+    }
+
+    void resolve(std::size_t resolution)
+    {
+        m_resolution = resolution;
+        if (resolution == 0) {
+            return;
+        }
+        for (auto variant = 0U; variant < NOTE_FLAG_VARIANT_COUNT; ++variant) {
+            const auto resolved_variant
+                = resolve_flag_variant(variant, resolution);
+            if (resolved_variant == variant) {
+                continue;
+            }
+            auto& events = m_note_ons.at(variant);
+            auto& resolved = m_note_ons.at(resolved_variant);
+            std::vector<int> merged;
+            merged.reserve(resolved.size() + events.size());
+            std::merge(resolved.cbegin(), resolved.cend(), events.cbegin(),
+                       events.cend(), std::back_inserter(merged));
+            resolved = std::move(merged);
+            events.clear();
+        }
+    }
+
+    [[nodiscard]] bool has_note_ons(std::size_t variant) const
+    {
+        return !m_note_ons.at(variant).empty();
+    }
+
+    [[nodiscard]] const std::vector<int>& note_ons(std::size_t variant) const
+    {
+        if (!m_has_off_events) {
+            throw SightRead::ParseError("No corresponding Note Off events");
+        }
+        if (m_unpaired_counts.at(m_resolution).at(variant) > 0) {
+            throw SightRead::ParseError(
+                "on event has no corresponding off event");
+        }
+        return m_note_ons.at(variant);
+    }
+};
+
 struct InstrumentMidiTrack {
 public:
-    std::map<std::tuple<SightRead::Difficulty, int, SightRead::NoteFlags>,
-             std::vector<std::tuple<int, int>>>
-        note_on_events;
-    std::map<std::tuple<SightRead::Difficulty, int>,
-             std::vector<std::tuple<int, int>>>
-        note_off_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        open_on_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        open_off_events;
-    std::vector<std::tuple<int, int>> yellow_tom_on_events;
-    std::vector<std::tuple<int, int>> yellow_tom_off_events;
-    std::vector<std::tuple<int, int>> blue_tom_on_events;
-    std::vector<std::tuple<int, int>> blue_tom_off_events;
-    std::vector<std::tuple<int, int>> green_tom_on_events;
-    std::vector<std::tuple<int, int>> green_tom_off_events;
-    std::vector<std::tuple<int, int>> solo_on_events;
-    std::vector<std::tuple<int, int>> solo_off_events;
-    std::vector<std::tuple<int, int>> sp_on_events;
-    std::vector<std::tuple<int, int>> sp_off_events;
-    std::vector<std::tuple<int, int>> tap_on_events;
-    std::vector<std::tuple<int, int>> tap_off_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        force_hopo_on_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        force_hopo_off_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        force_strum_on_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        force_strum_off_events;
-    std::vector<std::tuple<int, int>> fill_on_events;
-    std::vector<std::tuple<int, int>> fill_off_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        disco_flip_on_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        disco_flip_off_events;
+    PerDifficulty<PerColour<EventSpans>> note_events;
+    PerDifficulty<PerColour<DrumPadEvents>> drum_pad_events;
+    PerDifficulty<EventSpans> open_events;
+    EventSpans yellow_tom_events;
+    EventSpans blue_tom_events;
+    EventSpans green_tom_events;
+    EventSpans solo_events;
+    std::vector<int> solo_on_events;
+    std::vector<int> solo_off_events;
+    std::vector<std::tuple<SightRead::Tick, SightRead::Tick>> solo_ranges;
+    EventSpans sp_events;
+    EventSpans tap_events;
+    PerDifficulty<EventSpans> force_hopo_events;
+    PerDifficulty<EventSpans> force_strum_events;
+    EventSpans fill_events;
+    PerDifficulty<EventSpans> disco_flip_events;
+    std::optional<SightRead::BigRockEnding> bre;
 
     InstrumentMidiTrack() = default;
 };
 
 void add_sysex_event(InstrumentMidiTrack& track,
-                     const SightRead::Detail::SysexEvent& event, int time,
-                     int rank)
+                     const SightRead::Detail::SysexEvent& event, int time)
 {
-    constexpr std::array<SightRead::Difficulty, 4> OPEN_EVENT_DIFFS {
-        SightRead::Difficulty::Easy, SightRead::Difficulty::Medium,
-        SightRead::Difficulty::Hard, SightRead::Difficulty::Expert};
     constexpr int SYSEX_ON_INDEX = 6;
 
     if (!is_open_event_sysex(event)) {
         return;
     }
-    const auto diff = OPEN_EVENT_DIFFS.at(event.data[4]);
+    const std::size_t diff = event.data[4];
     if (event.data[SYSEX_ON_INDEX] == 0) {
-        track.open_off_events[diff].emplace_back(time, rank);
+        track.open_events.at(diff).add_off(time);
     } else {
-        track.open_on_events[diff].emplace_back(time, rank);
+        track.open_events.at(diff).add_on(time);
     }
 }
 
 void append_disco_flip(InstrumentMidiTrack& event_track,
-                       const SightRead::Detail::MetaEvent& meta_event, int time,
-                       int rank)
+                       const SightRead::Detail::MetaEvent& meta_event, int time)
 {
     constexpr int FLIP_START_SIZE = 15;
     constexpr int FLIP_END_SIZE = 14;
@@ -448,144 +411,287 @@ void append_disco_flip(InstrumentMidiTrack& event_track,
         && meta_event.data.size() != FLIP_END_SIZE) {
         return;
     }
-    if (!std::equal(MIX.cbegin(), MIX.cend(), meta_event.data.cbegin())) {
+    if (!std::equal(MIX.cbegin(), MIX.cend(), meta_event.data.begin())) {
         return;
     }
     if (!std::equal(DRUMS.cbegin(), DRUMS.cend(),
-                    meta_event.data.cbegin() + MIX.size() + 1)) {
+                    meta_event.data.begin() + MIX.size() + 1)) {
+        return;
+    }
+    const auto diff = static_cast<std::size_t>(meta_event.data[MIX.size()])
+        - static_cast<std::size_t>('0');
+    if (diff >= DIFFICULTY_COUNT) {
         return;
     }
-    const auto diff
-        = static_cast<SightRead::Difficulty>(meta_event.data[MIX.size()] - '0');
     if (meta_event.data.size() == FLIP_END_SIZE
         && meta_event.data[FLIP_END_SIZE - 1] == ']') {
-        event_track.disco_flip_off_events[diff].emplace_back(time, rank);
+        event_track.disco_flip_events.at(diff).add_off(time);
     } else if (meta_event.data.size() == FLIP_START_SIZE
                && meta_event.data[FLIP_START_SIZE - 2] == 'd'
                && meta_event.data[FLIP_START_SIZE - 1] == ']') {
-        event_track.disco_flip_on_events[diff].emplace_back(time, rank);
+        event_track.disco_flip_events.at(diff).add_on(time);
     }
 }
 
-bool force_hopo_key(std::uint8_t key, SightRead::TrackType track_type)
+enum class KeyRole : std::uint8_t {
+    None,
+    Note,
+    ForceHopo,
+    ForceStrum,
+    YellowTom,
+    BlueTom,
+    GreenTom,
+    Solo,
+    StarPower,
+    Tap,
+    DrumFill
+};
+
+struct KeyInfo {
+    KeyRole role {KeyRole::None};
+    std::uint8_t difficulty {0};
+    std::uint8_t colour {0};
+    bool is_cymbal {false};
+    bool is_five_lane_green {false};
+};
+
+// Indexed by the whole key byte, since the MIDI parser does not reject data
+// bytes above 127; those keys have no role.
+using KeyTable = std::array<KeyInfo, std::numeric_limits<std::uint8_t>::max()
+                                         + std::size_t {1}>;
+
+// Each difficulty's keys start at lowest_keys[diff] with one key per colour.
+// Guitar tracks follow these with the force HOPO and force strum keys, while
+// the last drum key is the five lane green.
+template <std::size_t N>
+constexpr KeyTable
+make_key_table(const std::array<int, DIFFICULTY_COUNT>& lowest_keys,
+               const std::array<int, N>& colours,
+               SightRead::TrackType track_type)
 {
-    constexpr std::array FORCE_HOPO_KEYS {65, 77, 89, 101};
-    if (track_type == SightRead::TrackType::Drums) {
-        return false;
+    constexpr std::array<std::tuple<int, KeyRole>, 7> SPECIAL_KEYS {
+        std::tuple {103, KeyRole::Solo}, // NOLINT
+        {104, KeyRole::Tap}, // NOLINT
+        {110, KeyRole::YellowTom}, // NOLINT
+        {111, KeyRole::BlueTom}, // NOLINT
+        {112, KeyRole::GreenTom}, // NOLINT
+        {116, KeyRole::StarPower}, // NOLINT
+        {120, KeyRole::DrumFill}}; // NOLINT
+
+    KeyTable table {};
+    for (const auto& [key, role] : SPECIAL_KEYS) {
+        table.at(key).role = role;
+    }
+    for (auto d = 0U; d < DIFFICULTY_COUNT; ++d) {
+        const auto lowest_key = static_cast<std::size_t>(lowest_keys.at(d));
+        const auto diff = static_cast<std::uint8_t>(d);
+        for (auto i = 0U; i < N; ++i) {
+            auto& info = table.at(lowest_key + i);
+            info.role = KeyRole::Note;
+            info.difficulty = diff;
+            info.colour = static_cast<std::uint8_t>(colours.at(i));
+            if (track_type == SightRead::TrackType::Drums) {
+                info.is_cymbal
+                    = is_cymbal_key(static_cast<int>(lowest_key + i));
+            }
+        }
+        if (track_type == SightRead::TrackType::Drums) {
+            table.at(lowest_key + N - 1).is_five_lane_green = true;
+        } else {
+            table.at(lowest_key + N) = {KeyRole::ForceHopo, diff};
+            table.at(lowest_key + N + 1) = {KeyRole::ForceStrum, diff};
+        }
     }
-    return std::find(FORCE_HOPO_KEYS.cbegin(), FORCE_HOPO_KEYS.cend(), key)
-        != FORCE_HOPO_KEYS.cend();
+    return table;
 }
 
-bool force_strum_key(std::uint8_t key, SightRead::TrackType track_type)
+constexpr KeyTable FIVE_FRET_KEYS = make_key_table(
+    std::array {60, 72, 84, 96}, // NOLINT
+    std::array<int, 5> {SightRead::FIVE_FRET_GREEN, SightRead::FIVE_FRET_RED,
+                        SightRead::FIVE_FRET_YELLOW, SightRead::FIVE_FRET_BLUE,
+                        SightRead::FIVE_FRET_ORANGE},
+    SightRead::TrackType::FiveFret);
+
+constexpr KeyTable SIX_FRET_KEYS = make_key_table(
+    std::array {58, 70, 82, 94}, // NOLINT
+    std::array<int, 7> {
+        SightRead::SIX_FRET_OPEN, SightRead::SIX_FRET_WHITE_LOW,
+        SightRead::SIX_FRET_WHITE_MID, SightRead::SIX_FRET_WHITE_HIGH,
+        SightRead::SIX_FRET_BLACK_LOW, SightRead::SIX_FRET_BLACK_MID,
+        SightRead::SIX_FRET_BLACK_HIGH},
+    SightRead::TrackType::SixFret);
+
+// The five lane green key is only present in five lane tracks, so this table
+// serves both four and five lane tracks.
+constexpr KeyTable DRUM_KEYS = make_key_table(
+    std::array {59, 71, 83, 95}, // NOLINT
+    std::array<int, 7> {SightRead::DRUM_DOUBLE_KICK, SightRead::DRUM_KICK,
+                        SightRead::DRUM_RED, SightRead::DRUM_YELLOW,
+                        SightRead::DRUM_BLUE, SightRead::DRUM_GREEN,
+                        SightRead::DRUM_GREEN},
+    SightRead::TrackType::Drums);
+
+const KeyTable& key_table(SightRead::TrackType track_type)
 {
-    constexpr std::array FORCE_STRUM_KEYS {66, 78, 90, 102};
-    if (track_type == SightRead::TrackType::Drums) {
-        return false;
+    switch (track_type) {
+    case SightRead::TrackType::FiveFret:
+        return FIVE_FRET_KEYS;
+    case SightRead::TrackType::SixFret:
+        return SIX_FRET_KEYS;
+    case SightRead::TrackType::Drums:
+        return DRUM_KEYS;
+    default:
+        throw std::invalid_argument("Invalid track type");
     }
-    return std::find(FORCE_STRUM_KEYS.cbegin(), FORCE_STRUM_KEYS.cend(), key)
-        != FORCE_STRUM_KEYS.cend();
 }
 
-void add_note_off_event(InstrumentMidiTrack& track,
-                        const std::array<std::uint8_t, 2>& data, int time,
-                        int rank, bool from_five_lane,
-                        SightRead::TrackType track_type)
+void add_note_off_event(InstrumentMidiTrack& track, const KeyInfo& key,
+                        int time, SightRead::TrackType track_type)
 {
-    constexpr int YELLOW_TOM_ID = 110;
-    constexpr int BLUE_TOM_ID = 111;
-    constexpr int GREEN_TOM_ID = 112;
-    constexpr int SOLO_NOTE_ID = 103;
-    constexpr int SP_NOTE_ID = 116;
-    constexpr int TAP_NOTE_ID = 104;
-    constexpr int DRUM_FILL_ID = 120;
-
-    const auto diff = difficulty_from_key(data[0], track_type);
-    if (diff.has_value()) {
-        if (force_hopo_key(data[0], track_type)) {
-            track.force_hopo_off_events[*diff].emplace_back(time, rank);
-        } else if (force_strum_key(data[0], track_type)) {
-            track.force_strum_off_events[*diff].emplace_back(time, rank);
+    switch (key.role) {
+    case KeyRole::None:
+        break;
+    case KeyRole::Note:
+        if (track_type == SightRead::TrackType::Drums) {
+            track.drum_pad_events.at(key.difficulty).at(key.colour).add_off();
         } else {
-            const auto colour
-                = colour_from_key(data[0], track_type, from_five_lane);
-            track.note_off_events[{*diff, colour}].emplace_back(time, rank);
+            track.note_events.at(key.difficulty).at(key.colour).add_off(time);
         }
-    } else if (data[0] == YELLOW_TOM_ID) {
-        track.yellow_tom_off_events.emplace_back(time, rank);
-    } else if (data[0] == BLUE_TOM_ID) {
-        track.blue_tom_off_events.emplace_back(time, rank);
-    } else if (data[0] == GREEN_TOM_ID) {
-        track.green_tom_off_events.emplace_back(time, rank);
-    } else if (data[0] == SOLO_NOTE_ID) {
-        track.solo_off_events.emplace_back(time, rank);
-    } else if (data[0] == SP_NOTE_ID) {
-        track.sp_off_events.emplace_back(time, rank);
-    } else if (data[0] == TAP_NOTE_ID) {
-        track.tap_off_events.emplace_back(time, rank);
-    } else if (data[0] == DRUM_FILL_ID) {
-        track.fill_off_events.emplace_back(time, rank);
+        break;
+    case KeyRole::ForceHopo:
+        track.force_hopo_events.at(key.difficulty).add_off(time);
+        break;
+    case KeyRole::ForceStrum:
+        track.force_strum_events.at(key.difficulty).add_off(time);
+        break;
+    case KeyRole::YellowTom:
+        track.yellow_tom_events.add_off(time);
+        break;
+    case KeyRole::BlueTom:
+        track.blue_tom_events.add_off(time);
+        break;
+    case KeyRole::GreenTom:
+        track.green_tom_events.add_off(time);
+        break;
+    case KeyRole::Solo:
+        track.solo_events.add_off(time);
+        track.solo_off_events.push_back(time);
+        break;
+    case KeyRole::StarPower:
+        track.sp_events.add_off(time);
+        break;
+    case KeyRole::Tap:
+        track.tap_events.add_off(time);
+        break;
+    case KeyRole::DrumFill:
+        track.fill_events.add_off(time);
+        break;
     }
 }
 
-void add_note_on_event(InstrumentMidiTrack& track,
-                       const std::array<std::uint8_t, 2>& data, int time,
-                       int rank, bool from_five_lane, bool parse_dynamics,
+void add_note_on_event(InstrumentMidiTrack& track, const KeyInfo& key,
+                       const SightRead::Detail::PackedEvent& event,
                        SightRead::TrackType track_type)
 {
-    constexpr int YELLOW_TOM_ID = 110;
-    constexpr int BLUE_TOM_ID = 111;
-    constexpr int GREEN_TOM_ID = 112;
-    constexpr int SOLO_NOTE_ID = 103;
-    constexpr int SP_NOTE_ID = 116;
-    constexpr int TAP_NOTE_ID = 104;
-    constexpr int DRUM_FILL_ID = 120;
+    const auto time = event.time;
+    const auto velocity = event.data[1];
 
     // Velocity 0 Note On events are counted as Note Off events.
-    if (data[1] == 0) {
-        add_note_off_event(track, data, time, rank, from_five_lane, track_type);
+    if (velocity == 0) {
+        add_note_off_event(track, key, time, track_type);
         return;
     }
 
-    const auto diff = difficulty_from_key(data[0], track_type);
-    if (diff.has_value()) {
-        if (force_hopo_key(data[0], track_type)) {
-            track.force_hopo_on_events[*diff].emplace_back(time, rank);
-        } else if (force_strum_key(data[0], track_type)) {
-            track.force_strum_on_events[*diff].emplace_back(time, rank);
-        } else {
-            auto colour = colour_from_key(data[0], track_type, from_five_lane);
-            auto flags = flags_from_track_type(track_type);
-            if (track_type == SightRead::TrackType::Drums) {
-                if (is_cymbal_key(data[0], from_five_lane)) {
-                    flags = static_cast<SightRead::NoteFlags>(
-                        flags | SightRead::FLAGS_CYMBAL);
-                }
-                if (parse_dynamics) {
-                    flags = static_cast<SightRead::NoteFlags>(
-                        flags | dynamics_flags_from_velocity(data[1]));
-                }
+    switch (key.role) {
+    case KeyRole::None:
+        break;
+    case KeyRole::Note: {
+        if (track_type != SightRead::TrackType::Drums) {
+            track.note_events.at(key.difficulty).at(key.colour).add_on(time);
+            break;
+        }
+        auto flags = dynamics_flags_from_velocity(velocity);
+        if (key.is_cymbal) {
+            flags = static_cast<SightRead::NoteFlags>(
+                flags | SightRead::FLAGS_CYMBAL);
+        }
+        track.drum_pad_events.at(key.difficulty)
+            .at(key.colour)
+            .add_on(time, flag_variant_index(flags));
+        break;
+    }
+    case KeyRole::ForceHopo:
+        track.force_hopo_events.at(key.difficulty).add_on(time);
+        break;
+    case KeyRole::ForceStrum:
+        track.force_strum_events.at(key.difficulty).add_on(time);
+        break;
+    case KeyRole::YellowTom:
+        track.yellow_tom_events.add_on(time);
+        break;
+    case KeyRole::BlueTom:
+        track.blue_tom_events.add_on(time);
+        break;
+    case KeyRole::GreenTom:
+        track.green_tom_events.add_on(time);
+        break;
+    case KeyRole::Solo:
+        track.solo_events.add_on(time);
+        track.solo_on_events.push_back(time);
+        break;
+    case KeyRole::StarPower:
+        track.sp_events.add_on(time);
+        break;
+    case KeyRole::Tap:
+        track.tap_events.add_on(time);
+        break;
+    case KeyRole::DrumFill:
+        track.fill_events.add_on(time);
+        break;
+    }
+}
+
+// The Big Rock Ending runs from the last Note On of its key to the first Note
+// Off after it.
+void add_bre_event(InstrumentMidiTrack& track,
+                   const SightRead::Detail::PackedEvent& event, int& bre_start)
+{
+    constexpr int BRE_KEY = 120;
+    constexpr int NOTE_ON_ID = 0x90;
+    constexpr int UPPER_NIBBLE_MASK = 0xF0;
+
+    if (event.data[0] != BRE_KEY || track.bre.has_value()) {
+        return;
+    }
+    if ((event.status & UPPER_NIBBLE_MASK) == NOTE_ON_ID
+        && event.data[1] != 0) {
+        bre_start = event.time;
+        return;
+    }
+    track.bre = {SightRead::Tick {bre_start}, SightRead::Tick {event.time}};
+}
+
+// Drum Note Ons are first read as though every pad could be a cymbal and with
+// their dynamics, since whether the track is five lane or has dynamics enabled
+// is only known once all of it is read. This drops the flags that do not apply
+// and merges the Note On lists whose flags then coincide.
+void resolve_drum_flags(InstrumentMidiTrack& track, bool from_five_lane,
+                        bool parse_dynamics)
+{
+    for (auto& pads : track.drum_pad_events) {
+        for (auto colour = 0U; colour < pads.size(); ++colour) {
+            auto resolution = parse_dynamics ? 0 : DROP_DYNAMICS;
+            if (from_five_lane && colour == SightRead::DRUM_BLUE) {
+                resolution |= DROP_CYMBAL;
             }
-            track.note_on_events[{*diff, colour, flags}].emplace_back(time,
-                                                                      rank);
+            pads.at(colour).resolve(resolution);
         }
-    } else if (data[0] == YELLOW_TOM_ID) {
-        track.yellow_tom_on_events.emplace_back(time, rank);
-    } else if (data[0] == BLUE_TOM_ID) {
-        track.blue_tom_on_events.emplace_back(time, rank);
-    } else if (data[0] == GREEN_TOM_ID) {
-        track.green_tom_on_events.emplace_back(time, rank);
-    } else if (data[0] == SOLO_NOTE_ID) {
-        track.solo_on_events.emplace_back(time, rank);
-    } else if (data[0] == SP_NOTE_ID) {
-        track.sp_on_events.emplace_back(time, rank);
-    } else if (data[0] == TAP_NOTE_ID) {
-        track.tap_on_events.emplace_back(time, rank);
-    } else if (data[0] == DRUM_FILL_ID) {
-        track.fill_on_events.emplace_back(time, rank);
     }
 }
 
+// Reads every event of the track in one pass. Properties of the whole track
+// (five lane drums, drum dynamics) are applied afterwards by
+// resolve_drum_flags.
 InstrumentMidiTrack
 read_instrument_midi_track(const SightRead::Detail::MidiTrack& midi_track,
                            SightRead::TrackType track_type)
@@ -593,150 +699,131 @@ read_instrument_midi_track(const SightRead::Detail::MidiTrack& midi_track,
     constexpr int NOTE_OFF_ID = 0x80;
     constexpr int NOTE_ON_ID = 0x90;
     constexpr int UPPER_NIBBLE_MASK = 0xF0;
-    constexpr std::array DIFFICULTIES {
-        SightRead::Difficulty::Easy, SightRead::Difficulty::Medium,
-        SightRead::Difficulty::Hard, SightRead::Difficulty::Expert};
 
-    const bool from_five_lane = track_type == SightRead::TrackType::Drums
-        && has_five_lane_green_notes(midi_track);
-    const bool parse_dynamics = track_type == SightRead::TrackType::Drums
-        && has_enable_chart_dynamics(midi_track);
+    bool from_five_lane = false;
+    bool parse_dynamics = false;
+    int bre_start = 0;
 
+    const auto& keys = key_table(track_type);
     InstrumentMidiTrack event_track;
-    for (auto d : DIFFICULTIES) {
-        event_track.disco_flip_on_events[d] = {};
-        event_track.disco_flip_off_events[d] = {};
-        event_track.force_hopo_on_events[d] = {};
-        event_track.force_hopo_off_events[d] = {};
-        event_track.force_strum_on_events[d] = {};
-        event_track.force_strum_off_events[d] = {};
-    }
 
-    int rank = 0;
     for (const auto& event : midi_track.events) {
-        ++rank;
-        const auto* midi_event
-            = std::get_if<SightRead::Detail::MidiEvent>(&event.event);
-        if (midi_event == nullptr) {
-            const auto* sysex_event
-                = std::get_if<SightRead::Detail::SysexEvent>(&event.event);
-            if (sysex_event != nullptr) {
-                add_sysex_event(event_track, *sysex_event, event.time, rank);
-                continue;
-            }
+        switch (event.status) {
+        case SightRead::Detail::PackedEvent::SYSEX_STATUS:
+            add_sysex_event(event_track,
+                            midi_track.sysex_events[event.side_index()],
+                            event.time);
+            continue;
+        case SightRead::Detail::PackedEvent::META_STATUS:
             if (track_type == SightRead::TrackType::Drums) {
-                const auto* meta_event
-                    = std::get_if<SightRead::Detail::MetaEvent>(&event.event);
-                if (meta_event != nullptr) {
-                    append_disco_flip(event_track, *meta_event, event.time,
-                                      rank);
-                }
+                const auto& meta_event
+                    = midi_track.meta_events[event.side_index()];
+                parse_dynamics
+                    = parse_dynamics || is_enable_chart_dynamics(meta_event);
+                append_disco_flip(event_track, meta_event, event.time);
             }
-
             continue;
         }
-        switch (midi_event->status & UPPER_NIBBLE_MASK) {
-        case NOTE_OFF_ID:
-            add_note_off_event(event_track, midi_event->data, event.time, rank,
-                               from_five_lane, track_type);
-            break;
-        case NOTE_ON_ID:
-            add_note_on_event(event_track, midi_event->data, event.time, rank,
-                              from_five_lane, parse_dynamics, track_type);
-            break;
+        const auto event_type = event.status & UPPER_NIBBLE_MASK;
+        if (event_type != NOTE_OFF_ID && event_type != NOTE_ON_ID) {
+            continue;
+        }
+        const auto& key = keys.at(event.data[0]);
+        from_five_lane = from_five_lane || key.is_five_lane_green;
+        add_bre_event(event_track, event, bre_start);
+        if (event_type == NOTE_OFF_ID) {
+            add_note_off_event(event_track, key, event.time, track_type);
+        } else {
+            add_note_on_event(event_track, key, event, track_type);
         }
     }
 
-    event_track.disco_flip_off_events.at(SightRead::Difficulty::Easy)
-        .emplace_back(std::numeric_limits<int>::max(), ++rank);
-    event_track.disco_flip_off_events.at(SightRead::Difficulty::Medium)
-        .emplace_back(std::numeric_limits<int>::max(), ++rank);
-    event_track.disco_flip_off_events.at(SightRead::Difficulty::Hard)
-        .emplace_back(std::numeric_limits<int>::max(), ++rank);
-    event_track.disco_flip_off_events.at(SightRead::Difficulty::Expert)
-        .emplace_back(std::numeric_limits<int>::max(), ++rank);
-
-    if (event_track.sp_on_events.empty()
-        && event_track.solo_on_events.size() > 1) {
-        std::swap(event_track.sp_off_events, event_track.solo_off_events);
-        std::swap(event_track.sp_on_events, event_track.solo_on_events);
+    if (track_type == SightRead::TrackType::Drums) {
+        resolve_drum_flags(event_track, from_five_lane, parse_dynamics);
+    }
+
+    for (auto& disco_flips : event_track.disco_flip_events) {
+        disco_flips.add_off(std::numeric_limits<int>::max());
+    }
+
+    // Without Star Power phrases, the solo markers are the Star Power phrases
+    // instead. The solo lists are then left without Note Ons, so no solos.
+    if (!event_track.sp_events.has_on_events()
+        && event_track.solo_events.on_event_count() > 1) {
+        event_track.sp_events = std::move(event_track.solo_events);
+        event_track.solo_on_events.clear();
+        event_track.solo_off_events.clear();
     }
+    event_track.solo_ranges = SightRead::Detail::combine_solo_events(
+        event_track.solo_on_events, event_track.solo_off_events);
 
     return event_track;
 }
 
-bool position_in_event_spans(
-    const std::vector<std::tuple<int, int>>& event_spans, int position)
+// The spans from EventSpans have non-decreasing starts and ends, so only the
+// last span starting at or before position can contain it.
+bool position_in_event_spans(const EventSpanList& event_spans, int position)
 {
-    return std::any_of(event_spans.cbegin(), event_spans.cend(),
-                       [&](const auto& span) {
-                           return position >= std::get<0>(span)
-                               && position < std::get<1>(span);
-                       });
+    const auto next_span = std::upper_bound(
+        event_spans.cbegin(), event_spans.cend(), position,
+        [](int pos, const auto& span) { return pos < std::get<0>(span); });
+    return next_span != event_spans.cbegin()
+        && position < std::get<1>(*std::prev(next_span));
 }
 
 std::map<SightRead::Difficulty, std::vector<SightRead::Note>>
 notes_from_event_track(
     const InstrumentMidiTrack& event_track,
-    const std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>&
-        open_events,
+    const PerDifficulty<EventSpanList>& open_events,
     SightRead::TrackType track_type)
 {
-    constexpr std::array DIFFICULTIES {
-        SightRead::Difficulty::Easy, SightRead::Difficulty::Medium,
-        SightRead::Difficulty::Hard, SightRead::Difficulty::Expert};
-
-    const auto tap_events = combine_note_on_off_events(
-        event_track.tap_on_events, event_track.tap_off_events);
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        force_hopo_events;
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        force_strum_events;
-    for (auto d : DIFFICULTIES) {
-        force_hopo_events[d] = combine_note_on_off_events(
-            event_track.force_hopo_on_events.at(d),
-            event_track.force_hopo_off_events.at(d));
-        force_strum_events[d] = combine_note_on_off_events(
-            event_track.force_strum_on_events.at(d),
-            event_track.force_strum_off_events.at(d));
+    const auto& tap_events = event_track.tap_events.spans();
+
+    PerDifficulty<const EventSpanList*> force_hopo_events {};
+    PerDifficulty<const EventSpanList*> force_strum_events {};
+    for (auto d = 0U; d < DIFFICULTY_COUNT; ++d) {
+        force_hopo_events.at(d) = &event_track.force_hopo_events.at(d).spans();
+        force_strum_events.at(d)
+            = &event_track.force_strum_events.at(d).spans();
     }
 
     std::map<SightRead::Difficulty, std::vector<SightRead::Note>> notes;
-    for (const auto& [key, note_ons] : event_track.note_on_events) {
-        const auto& [diff, colour, flags] = key;
-        if (!event_track.note_off_events.contains({diff, colour})) {
-            throw SightRead::ParseError("No corresponding Note Off events");
-        }
-        const auto& note_offs = event_track.note_off_events.at({diff, colour});
-        for (const auto& [pos, end] :
-             combine_note_on_off_events(note_ons, note_offs)) {
-            const auto note_length = end - pos;
-            auto note_colour = colour;
-            if (track_type == SightRead::TrackType::FiveFret) {
-                const auto open_events_iter = open_events.find(diff);
-                if (open_events_iter != open_events.cend()
-                    && position_in_event_spans(open_events_iter->second, pos)) {
-                    note_colour = SightRead::FIVE_FRET_OPEN;
-                }
-            }
-            SightRead::Note note;
-            note.position = SightRead::Tick {pos};
-            note.lengths.at(note_colour) = SightRead::Tick {note_length};
-            note.flags = flags_from_track_type(track_type);
-            if (position_in_event_spans(tap_events, pos)
-                && track_type != SightRead::TrackType::Drums) {
-                note.flags = static_cast<SightRead::NoteFlags>(
-                    note.flags | SightRead::FLAGS_TAP);
+    for (auto d = 0U; d < DIFFICULTY_COUNT; ++d) {
+        const auto diff = static_cast<SightRead::Difficulty>(d);
+        for (auto colour = 0U; colour < MAX_COLOUR_COUNT; ++colour) {
+            const auto& note_events = event_track.note_events.at(d).at(colour);
+            if (!note_events.has_on_events()) {
+                continue;
             }
-            if (position_in_event_spans(force_hopo_events[diff], pos)) {
-                note.flags = static_cast<SightRead::NoteFlags>(
-                    note.flags | SightRead::FLAGS_FORCE_HOPO);
+            if (!note_events.has_off_events()) {
+                throw SightRead::ParseError("No corresponding Note Off events");
             }
-            if (position_in_event_spans(force_strum_events[diff], pos)) {
-                note.flags = static_cast<SightRead::NoteFlags>(
-                    note.flags | SightRead::FLAGS_FORCE_STRUM);
+            for (const auto& [pos, end] : note_events.spans()) {
+                const auto note_length = end - pos;
+                auto note_colour = colour;
+                if (track_type == SightRead::TrackType::FiveFret
+                    && position_in_event_spans(open_events.at(d), pos)) {
+                    note_colour = SightRead::FIVE_FRET_OPEN;
+                }
+                SightRead::Note note;
+                note.position = SightRead::Tick {pos};
+                note.lengths.at(note_colour) = SightRead::Tick {note_length};
+                note.flags = flags_from_track_type(track_type);
+                if (position_in_event_spans(tap_events, pos)
+                    && track_type != SightRead::TrackType::Drums) {
+                    note.flags = static_cast<SightRead::NoteFlags>(
+                        note.flags | SightRead::FLAGS_TAP);
+                }
+                if (position_in_event_spans(*force_hopo_events.at(d), pos)) {
+                    note.flags = static_cast<SightRead::NoteFlags>(
+                        note.flags | SightRead::FLAGS_FORCE_HOPO);
+                }
+                if (position_in_event_spans(*force_strum_events.at(d), pos)) {
+                    note.flags = static_cast<SightRead::NoteFlags>(
+                        note.flags | SightRead::FLAGS_FORCE_STRUM);
+                }
+                notes[diff].push_back(note);
             }
-            notes[diff].push_back(note);
         }
     }
 
@@ -755,26 +842,16 @@ std::map<SightRead::Difficulty, SightRead::NoteTrack> ghl_note_tracks_from_midi(
                                               SightRead::TrackType::SixFret);
 
     std::vector<SightRead::StarPower> sp_phrases;
-    for (const auto& [start, end] : combine_note_on_off_events(
-             event_track.sp_on_events, event_track.sp_off_events)) {
+    for (const auto& [start, end] : event_track.sp_events.spans()) {
         sp_phrases.push_back(
             {SightRead::Tick {start}, SightRead::Tick {end - start}});
     }
 
     std::map<SightRead::Difficulty, SightRead::NoteTrack> note_tracks;
     for (const auto& [diff, note_set] : notes) {
-        std::vector<int> solo_ons;
-        std::vector<int> solo_offs;
-        solo_ons.reserve(event_track.solo_on_events.size());
-        for (const auto& [pos, rank] : event_track.solo_on_events) {
-            solo_ons.push_back(pos);
-        }
-        solo_offs.reserve(event_track.solo_off_events.size());
-        for (const auto& [pos, rank] : event_track.solo_off_events) {
-            solo_offs.push_back(pos);
-        }
         auto solos = SightRead::Detail::form_solo_vector(
-            solo_ons, solo_offs, note_set, SightRead::TrackType::SixFret, true);
+            event_track.solo_ranges, note_set, SightRead::TrackType::SixFret,
+            true);
         if (!permit_solos) {
             solos.clear();
         }
@@ -796,37 +873,24 @@ private:
 
 public:
     explicit TomEvents(const InstrumentMidiTrack& events)
-        : m_yellow_tom_events {combine_note_on_off_events(
-            events.yellow_tom_on_events, events.yellow_tom_off_events)}
-        , m_blue_tom_events {combine_note_on_off_events(
-              events.blue_tom_on_events, events.blue_tom_off_events)}
-        , m_green_tom_events {combine_note_on_off_events(
-              events.green_tom_on_events, events.green_tom_off_events)}
+        : m_yellow_tom_events {events.yellow_tom_events.spans()}
+        , m_blue_tom_events {events.blue_tom_events.spans()}
+        , m_green_tom_events {events.green_tom_events.spans()}
     {
     }
 
     [[nodiscard]] bool force_tom(int colour, int pos) const
     {
-        if (colour == SightRead::DRUM_YELLOW) {
-            for (const auto& [open_start, open_end] : m_yellow_tom_events) {
-                if (pos >= open_start && pos < open_end) {
-                    return true;
-                }
-            }
-        } else if (colour == SightRead::DRUM_BLUE) {
-            for (const auto& [open_start, open_end] : m_blue_tom_events) {
-                if (pos >= open_start && pos < open_end) {
-                    return true;
-                }
-            }
-        } else if (colour == SightRead::DRUM_GREEN) {
-            for (const auto& [open_start, open_end] : m_green_tom_events) {
-                if (pos >= open_start && pos < open_end) {
-                    return true;
-                }
-            }
+        switch (colour) {
+        case SightRead::DRUM_YELLOW:
+            return position_in_event_spans(m_yellow_tom_events, pos);
+        case SightRead::DRUM_BLUE:
+            return position_in_event_spans(m_blue_tom_events, pos);
+        case SightRead::DRUM_GREEN:
+            return position_in_event_spans(m_green_tom_events, pos);
+        default:
+            return false;
         }
-        return false;
     }
 };
 
@@ -867,64 +931,58 @@ drum_note_tracks_from_midi(
     const TomEvents tom_events {event_track};
 
     std::map<SightRead::Difficulty, std::vector<SightRead::Note>> notes;
-    for (const auto& [key, note_ons] : event_track.note_on_events) {
-        const auto& [diff, colour, flags] = key;
-        const std::tuple<SightRead::Difficulty, int> no_flags_key {diff,
-                                                                   colour};
-        if (!event_track.note_off_events.contains(no_flags_key)) {
-            throw SightRead::ParseError("No corresponding Note Off events");
-        }
-        const auto& note_offs = event_track.note_off_events.at(no_flags_key);
-        for (const auto& [pos, end] :
-             combine_note_on_off_events(note_ons, note_offs)) {
-            SightRead::Note note;
-            note.position = SightRead::Tick {pos};
-            note.lengths.at(colour) = SightRead::Tick {0};
-            note.flags = flags;
-            if (tom_events.force_tom(colour, pos)) {
-                note.flags = static_cast<SightRead::NoteFlags>(
-                    note.flags & ~SightRead::FLAGS_CYMBAL);
+    for (auto d = 0U; d < DIFFICULTY_COUNT; ++d) {
+        const auto diff = static_cast<SightRead::Difficulty>(d);
+        for (auto colour = 0U; colour < MAX_COLOUR_COUNT; ++colour) {
+            const auto& pad_events
+                = event_track.drum_pad_events.at(d).at(colour);
+            for (auto variant = 0U; variant < NOTE_FLAG_VARIANT_COUNT;
+                 ++variant) {
+                if (!pad_events.has_note_ons(variant)) {
+                    continue;
+                }
+                const auto flags = static_cast<SightRead::NoteFlags>(
+                    SightRead::FLAGS_DRUMS | variant);
+                for (auto pos : pad_events.note_ons(variant)) {
+                    SightRead::Note note;
+                    note.position = SightRead::Tick {pos};
+                    note.lengths.at(colour) = SightRead::Tick {0};
+                    note.flags = flags;
+                    if (tom_events.force_tom(static_cast<int>(colour), pos)) {
+                        note.flags = static_cast<SightRead::NoteFlags>(
+                            note.flags & ~SightRead::FLAGS_CYMBAL);
+                    }
+                    notes[diff].push_back(note);
+                }
+                fix_double_greens(notes[diff]);
             }
-            notes[diff].push_back(note);
         }
-        fix_double_greens(notes[diff]);
     }
 
     std::vector<SightRead::StarPower> sp_phrases;
-    for (const auto& [start, end] : combine_note_on_off_events(
-             event_track.sp_on_events, event_track.sp_off_events)) {
+    for (const auto& [start, end] : event_track.sp_events.spans()) {
         sp_phrases.push_back(
             {SightRead::Tick {start}, SightRead::Tick {end - start}});
     }
 
     std::vector<SightRead::DrumFill> drum_fills;
-    for (const auto& [start, end] : combine_note_on_off_events(
-             event_track.fill_on_events, event_track.fill_off_events)) {
+    for (const auto& [start, end] : event_track.fill_events.spans()) {
         drum_fills.push_back(
             {SightRead::Tick {start}, SightRead::Tick {end - start}});
     }
 
     std::map<SightRead::Difficulty, SightRead::NoteTrack> note_tracks;
     for (const auto& [diff, note_set] : notes) {
-        std::vector<int> solo_ons;
-        std::vector<int> solo_offs;
-        solo_ons.reserve(event_track.solo_on_events.size());
-        for (const auto& [pos, rank] : event_track.solo_on_events) {
-            solo_ons.push_back(pos);
-        }
-        solo_offs.reserve(event_track.solo_off_events.size());
-        for (const auto& [pos, rank] : event_track.solo_off_events) {
-            solo_offs.push_back(pos);
-        }
+        const auto d = difficulty_index(diff);
         std::vector<SightRead::DiscoFlip> disco_flips;
-        for (const auto& [start, end] : combine_note_on_off_events(
-                 event_track.disco_flip_on_events.at(diff),
-                 event_track.disco_flip_off_events.at(diff))) {
+        for (const auto& [start, end] :
+             event_track.disco_flip_events.at(d).spans()) {
             disco_flips.push_back(
                 {SightRead::Tick {start}, SightRead::Tick {end - start}});
         }
         auto solos = SightRead::Detail::form_solo_vector(
-            solo_ons, solo_offs, note_set, SightRead::TrackType::Drums, true);
+            event_track.solo_ranges, note_set, SightRead::TrackType::Drums,
+            true);
         if (!permit_solos) {
             solos.clear();
         }
@@ -939,39 +997,6 @@ drum_note_tracks_from_midi(
     return note_tracks;
 }
 
-std::optional<SightRead::BigRockEnding>
-read_bre(const SightRead::Detail::MidiTrack& midi_track)
-{
-    constexpr int BRE_KEY = 120;
-    constexpr int NOTE_OFF_ID = 0x80;
-    constexpr int NOTE_ON_ID = 0x90;
-    constexpr int UPPER_NIBBLE_MASK = 0xF0;
-
-    SightRead::Tick bre_start {0};
-
-    for (const auto& event : midi_track.events) {
-        const auto* midi_event
-            = std::get_if<SightRead::Detail::MidiEvent>(&event.event);
-        if (midi_event == nullptr) {
-            continue;
-        }
-        if (midi_event->data[0] != BRE_KEY) {
-            continue;
-        }
-        const auto event_type = midi_event->status & UPPER_NIBBLE_MASK;
-        if (event_type == NOTE_OFF_ID
-            || (event_type == NOTE_ON_ID && midi_event->data[1] == 0)) {
-            const SightRead::Tick bre_end {event.time};
-            return {{bre_start, bre_end}};
-        }
-        if (event_type == NOTE_ON_ID) {
-            bre_start = SightRead::Tick {event.time};
-        }
-    }
-
-    return std::nullopt;
-}
-
 std::map<SightRead::Difficulty, SightRead::NoteTrack> note_tracks_from_midi(
     const SightRead::Detail::MidiTrack& midi_track,
     const std::shared_ptr<SightRead::SongGlobalData>& global_data,
@@ -979,42 +1004,32 @@ std::map<SightRead::Difficulty, SightRead::NoteTrack> note_tracks_from_midi(
 {
     const auto event_track = read_instrument_midi_track(
         midi_track, SightRead::TrackType::FiveFret);
-    const auto bre = read_bre(midi_track);
 
-    std::map<SightRead::Difficulty, std::vector<std::tuple<int, int>>>
-        open_events;
-    for (const auto& [diff, open_ons] : event_track.open_on_events) {
-        if (!event_track.open_off_events.contains(diff)) {
+    PerDifficulty<EventSpanList> open_events;
+    for (auto d = 0U; d < DIFFICULTY_COUNT; ++d) {
+        const auto& events = event_track.open_events.at(d);
+        if (!events.has_on_events()) {
+            continue;
+        }
+        if (!events.has_off_events()) {
             throw SightRead::ParseError("No open Note Off events");
         }
-        const auto& open_offs = event_track.open_off_events.at(diff);
-        open_events[diff] = combine_note_on_off_events(open_ons, open_offs);
+        open_events.at(d) = events.spans();
     }
 
     const auto notes = notes_from_event_track(event_track, open_events,
                                               SightRead::TrackType::FiveFret);
 
     std::vector<SightRead::StarPower> sp_phrases;
-    for (const auto& [start, end] : combine_note_on_off_events(
-             event_track.sp_on_events, event_track.sp_off_events)) {
+    for (const auto& [start, end] : event_track.sp_events.spans()) {
         sp_phrases.push_back(
             {SightRead::Tick {start}, SightRead::Tick {end - start}});
     }
 
     std::map<SightRead::Difficulty, SightRead::NoteTrack> note_tracks;
     for (const auto& [diff, note_set] : notes) {
-        std::vector<int> solo_ons;
-        std::vector<int> solo_offs;
-        solo_ons.reserve(event_track.solo_on_events.size());
-        for (const auto& [pos, rank] : event_track.solo_on_events) {
-            solo_ons.push_back(pos);
-        }
-        solo_offs.reserve(event_track.solo_off_events.size());
-        for (const auto& [pos, rank] : event_track.solo_off_events) {
-            solo_offs.push_back(pos);
-        }
         auto solos = SightRead::Detail::form_solo_vector(
-            solo_ons, solo_offs, note_set, SightRead::TrackType::FiveFret,
+            event_track.solo_ranges, note_set, SightRead::TrackType::FiveFret,
             true);
         if (!permit_solos) {
             solos.clear();
@@ -1023,7 +1038,7 @@ std::map<SightRead::Difficulty, SightRead::NoteTrack> note_tracks_from_midi(
             note_set, sp_phrases, SightRead::TrackType::FiveFret, global_data,
             hopo_threshold.midi_max_hopo_gap(global_data->resolution())};
         note_track.solos(std::move(solos));
-        note_track.bre(bre);
+        note_track.bre(event_track.bre);
         note_tracks.emplace(diff, std::move(note_track));
     }
 
@@ -1039,6 +1054,7 @@ SightRead::Detail::MidiConverter::MidiConverter(SightRead::Metadata metadata)
                         SightRead::Tick {0}}
     , m_permitted_instruments {SightRead::all_instruments()}
     , m_permit_solos {true}
+    , m_worker_threads {1}
 {
 }
 
@@ -1065,6 +1081,23 @@ SightRead::Detail::MidiConverter::parse_solos(bool permit_solos)
     return *this;
 }
 
+SightRead::Detail::MidiConverter&
+SightRead::Detail::MidiConverter::worker_threads(unsigned int thread_count)
+{
+    m_worker_threads = thread_count;
+    return *this;
+}
+
+bool SightRead::Detail::MidiConverter::is_track_needed(
+    std::string_view track_name) const
+{
+    if (track_name == "BEAT") {
+        return true;
+    }
+    const auto inst = midi_section_instrument(track_name);
+    return inst.has_value() && m_permitted_instruments.contains(*inst);
+}
+
 SightRead::Song SightRead::Detail::MidiConverter::convert(
     const SightRead::Detail::Midi& midi) const
 {
@@ -1087,6 +1120,9 @@ SightRead::Song SightRead::Detail::MidiConverter::convert(
     song.global_data().tempo_map(
         read_first_midi_track(midi.tracks[0], midi.ticks_per_quarter_note));
 
+    std::vector<std::tuple<const SightRead::Detail::MidiTrack*,
+                           SightRead::Instrument>>
+        instrument_tracks;
     for (const auto& track : midi.tracks) {
         const auto track_name = midi_track_name(track);
         if (!track_name.has_value()) {
@@ -1096,30 +1132,34 @@ SightRead::Song SightRead::Detail::MidiConverter::convert(
             song.global_data().od_beats(od_beats_from_track(track));
         }
         const auto inst = midi_section_instrument(*track_name);
-        if (!inst.has_value() || !m_permitted_instruments.contains(*inst)) {
-            continue;
+        if (inst.has_value() && m_permitted_instruments.contains(*inst)) {
+            instrument_tracks.emplace_back(&track, *inst);
         }
-        if (SightRead::Detail::is_six_fret_instrument(*inst)) {
-            auto tracks
-                = ghl_note_tracks_from_midi(track, song.global_data_ptr(),
-                                            m_hopo_threshold, m_permit_solos);
-            for (auto& [diff, note_track] : tracks) {
-                song.add_note_track(*inst, diff, std::move(note_track));
-            }
-        } else if (*inst == SightRead::Instrument::Drums) {
-            auto tracks = drum_note_tracks_from_midi(
-                track, song.global_data_ptr(), m_permit_solos);
-            for (auto& [diff, note_track] : tracks) {
-                song.add_note_track(SightRead::Instrument::Drums, diff,
-                                    std::move(note_track));
+    }
+
+    // Instrument tracks only read the global data, so they can be converted
+    // independently. The tracks are added to the song in file order so the
+    // first track for an instrument still wins.
+    const auto global_data = song.global_data_ptr();
+    auto note_tracks = SightRead::Detail::parallel_map(
+        instrument_tracks.size(), m_worker_threads, [&](std::size_t i) {
+            const auto& [track, inst] = instrument_tracks[i];
+            if (SightRead::Detail::is_six_fret_instrument(inst)) {
+                return ghl_note_tracks_from_midi(*track, global_data,
+                                                 m_hopo_threshold,
+                                                 m_permit_solos);
             }
-        } else {
-            auto tracks
-                = note_tracks_from_midi(track, song.global_data_ptr(),
-                                        m_hopo_threshold, m_permit_solos);
-            for (auto& [diff, note_track] : tracks) {
-                song.add_note_track(*inst, diff, std::move(note_track));
+            if (inst == SightRead::Instrument::Drums) {
+                return drum_note_tracks_from_midi(*track, global_data,
+                                                  m_permit_solos);
             }
+            return note_tracks_from_midi(*track, global_data, m_hopo_threshold,
+                                         m_permit_solos);
+        });
+    for (auto i = 0U; i < instrument_tracks.size(); ++i) {
+        const auto inst = std::get<1>(instrument_tracks[i]);
+        for (auto& [diff, note_track] : note_tracks[i]) {
+            song.add_note_track(inst, diff, std::move(note_track));
         }
     }
 
@@ -3,6 +3,7 @@
 
 #include <set>
 #include <string>
+#include <string_view>
 
 #include "sightread/detail/midi.hpp"
 #include "sightread/hopothreshold.hpp"
@@ -19,6 +20,7 @@ private:
     SightRead::HopoThreshold m_hopo_threshold;
     std::set<SightRead::Instrument> m_permitted_instruments;
     bool m_permit_solos;
+    unsigned int m_worker_threads;
 
 public:
     explicit MidiConverter(SightRead::Metadata metadata);
@@ -26,6 +28,12 @@ public:
     MidiConverter&
     permit_instruments(std::set<SightRead::Instrument> permitted_instruments);
     MidiConverter& parse_solos(bool permit_solos);
+    // Sets the number of threads used to convert instrument tracks. The
+    // default of 1 does all the work on the calling thread.
+    MidiConverter& worker_threads(unsigned int thread_count);
+    // Whether convert reads anything from a track with this name, apart from
+    // the first track which is always read.
+    [[nodiscard]] bool is_track_needed(std::string_view track_name) const;
     SightRead::Song convert(const SightRead::Detail::Midi& midi) const;
 };
 }
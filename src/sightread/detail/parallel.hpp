@@ -0,0 +1,73 @@
+#ifndef SIGHTREAD_DETAIL_PARALLEL_HPP
+#define SIGHTREAD_DETAIL_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SightRead::Detail {
+// Calls task(i) for each i in [0, task_count) using up to thread_count
+// threads, including the calling thread, and returns the results in index
+// order. If any calls throw, the exception from the lowest index is rethrown
+// once every call has finished, so callers see the same exception they would
+// if the tasks were run serially in order.
+template <typename Task>
+std::vector<std::invoke_result_t<Task&, std::size_t>>
+parallel_map(std::size_t task_count, unsigned int thread_count, Task task)
+{
+    using Result = std::invoke_result_t<Task&, std::size_t>;
+
+    std::vector<std::optional<Result>> results(task_count);
+    std::vector<std::exception_ptr> exceptions(task_count);
+    std::atomic<std::size_t> next_task {0};
+
+    const auto run_tasks = [&] {
+        for (auto i = next_task++; i < task_count; i = next_task++) {
+            try {
+                results[i].emplace(task(i));
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const auto extra_threads = std::min<std::size_t>(
+        thread_count > 0 ? thread_count - 1 : 0, task_count);
+    threads.reserve(extra_threads);
+    for (std::size_t i = 0; i < extra_threads; ++i) {
+        try {
+            threads.emplace_back(run_tasks);
+        } catch (const std::system_error&) {
+            // The calling thread picks up the remaining work.
+            break;
+        }
+    }
+    run_tasks();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    std::vector<Result> output;
+    output.reserve(task_count);
+    for (auto& result : results) {
+        output.push_back(std::move(*result));
+    }
+    return output;
+}
+}
+
+#endif
@@ -1,8 +1,9 @@
 #include <algorithm>
 #include <array>
-#include <set>
+#include <iterator>
 
 #include "sightread/detail/parserutil.hpp"
+#include "sightread/detail/perfecthash.hpp"
 
 bool SightRead::Detail::is_six_fret_instrument(SightRead::Instrument instrument)
 {
@@ -14,6 +15,104 @@ bool SightRead::Detail::is_six_fret_instrument(SightRead::Instrument instrument)
         != SIX_FRET_INSTRUMENTS.cend();
 }
 
+namespace {
+using namespace std::literals;
+
+using DiffInst = std::tuple<SightRead::Difficulty, SightRead::Instrument>;
+
+constexpr std::array<std::tuple<std::string_view, SightRead::Difficulty>, 4>
+    DIFFICULTIES {std::tuple {"Easy"sv, SightRead::Difficulty::Easy},
+                  {"Medium"sv, SightRead::Difficulty::Medium},
+                  {"Hard"sv, SightRead::Difficulty::Hard},
+                  {"Expert"sv, SightRead::Difficulty::Expert}};
+constexpr std::array<std::tuple<std::string_view, SightRead::Instrument>, 10>
+    INSTRUMENTS {std::tuple {"Single"sv, SightRead::Instrument::Guitar},
+                 {"DoubleGuitar"sv, SightRead::Instrument::GuitarCoop},
+                 {"DoubleBass"sv, SightRead::Instrument::Bass},
+                 {"DoubleRhythm"sv, SightRead::Instrument::Rhythm},
+                 {"Keyboard"sv, SightRead::Instrument::Keys},
+                 {"GHLGuitar"sv, SightRead::Instrument::GHLGuitar},
+                 {"GHLBass"sv, SightRead::Instrument::GHLBass},
+                 {"GHLRhythm"sv, SightRead::Instrument::GHLRhythm},
+                 {"GHLCoop"sv, SightRead::Instrument::GHLGuitarCoop},
+                 {"Drums"sv, SightRead::Instrument::Drums}};
+
+constexpr std::size_t HEADER_COUNT = DIFFICULTIES.size() * INSTRUMENTS.size();
+constexpr std::size_t MAX_HEADER_SIZE = 18;
+constexpr std::size_t HEADER_TABLE_SIZE = 256;
+
+// The text of every difficulty and instrument pairing, such as "ExpertSingle",
+// for the header map's names to point into.
+constexpr auto HEADER_TEXTS = [] {
+    std::array<std::array<char, MAX_HEADER_SIZE>, HEADER_COUNT> texts {};
+    auto text = texts.begin();
+    for (const auto& diff : DIFFICULTIES) {
+        for (const auto& inst : INSTRUMENTS) {
+            const auto diff_name = std::get<0>(diff);
+            const auto inst_name = std::get<0>(inst);
+            const auto inst_start = std::copy(diff_name.cbegin(),
+                                              diff_name.cend(), text->begin());
+            std::copy(inst_name.cbegin(), inst_name.cend(), inst_start);
+            ++text;
+        }
+    }
+    return texts;
+}();
+
+constexpr auto INSTRUMENT_HEADERS = [] {
+    std::array<std::tuple<std::string_view, DiffInst>, HEADER_COUNT>
+        headers {};
+    auto header = headers.begin();
+    auto text = HEADER_TEXTS.cbegin();
+    for (const auto& [diff_name, diff] : DIFFICULTIES) {
+        for (const auto& [inst_name, inst] : INSTRUMENTS) {
+            *header = {std::string_view {text->data(),
+                                         diff_name.size() + inst_name.size()},
+                       DiffInst {diff, inst}};
+            ++header;
+            ++text;
+        }
+    }
+    return headers;
+}();
+
+constexpr SightRead::Detail::PerfectHashMap<DiffInst, HEADER_COUNT,
+                                            HEADER_TABLE_SIZE>
+    INSTRUMENT_HEADER_MAP {INSTRUMENT_HEADERS};
+
+// Headers only have to start with a difficulty and end with an instrument, so
+// headers other than the plain pairings are checked against each separately.
+std::optional<DiffInst> diff_inst_from_header_parts(std::string_view header)
+{
+    // NOLINT is required because following clang-tidy here causes the VS2017
+    // compile to fail.
+    auto diff_iter = std::find_if( // NOLINT
+        DIFFICULTIES.cbegin(), DIFFICULTIES.cend(), [&](const auto& pair) {
+            return header.starts_with(std::get<0>(pair));
+        });
+    if (diff_iter == DIFFICULTIES.cend()) {
+        return std::nullopt;
+    }
+    auto inst_iter = std::find_if( // NOLINT
+        INSTRUMENTS.cbegin(), INSTRUMENTS.cend(),
+        [&](const auto& pair) { return header.ends_with(std::get<0>(pair)); });
+    if (inst_iter == INSTRUMENTS.cend()) {
+        return std::nullopt;
+    }
+    return std::tuple {std::get<1>(*diff_iter), std::get<1>(*inst_iter)};
+}
+}
+
+std::optional<std::tuple<SightRead::Difficulty, SightRead::Instrument>>
+SightRead::Detail::diff_inst_from_header(std::string_view header)
+{
+    const auto diff_inst = INSTRUMENT_HEADER_MAP.find(header);
+    if (diff_inst.has_value()) {
+        return diff_inst;
+    }
+    return diff_inst_from_header_parts(header);
+}
+
 std::vector<std::tuple<SightRead::Tick, SightRead::Tick>>
 SightRead::Detail::combine_solo_events(const std::vector<int>& on_events,
                                        const std::vector<int>& off_events)
@@ -37,34 +136,44 @@ SightRead::Detail::combine_solo_events(const std::vector<int>& on_events,
     return ranges;
 }
 
-std::vector<SightRead::Solo>
-SightRead::Detail::form_solo_vector(const std::vector<int>& solo_on_events,
-                                    const std::vector<int>& solo_off_events,
-                                    const std::vector<SightRead::Note>& notes,
-                                    SightRead::TrackType track_type,
-                                    bool is_midi)
+std::vector<SightRead::Solo> SightRead::Detail::form_solo_vector(
+    const std::vector<std::tuple<SightRead::Tick, SightRead::Tick>>&
+        solo_ranges,
+    const std::vector<SightRead::Note>& notes, SightRead::TrackType track_type,
+    bool is_midi)
 {
     constexpr int SOLO_NOTE_VALUE = 100;
 
     std::vector<SightRead::Solo> solos;
+    if (solo_ranges.empty()) {
+        return solos;
+    }
 
-    for (auto [start, end] :
-         combine_solo_events(solo_on_events, solo_off_events)) {
-        std::set<SightRead::Tick> positions_in_solo;
-        auto note_count = 0;
-        for (const auto& note : notes) {
-            if ((note.position >= start && note.position < end)
-                || (note.position == end && !is_midi)) {
-                positions_in_solo.insert(note.position);
-                ++note_count;
-            }
-        }
-        if (positions_in_solo.empty()) {
+    // Drum solos count every note, while other solos count chords, so for
+    // those only the distinct positions are kept.
+    std::vector<SightRead::Tick> positions;
+    positions.reserve(notes.size());
+    for (const auto& note : notes) {
+        positions.push_back(note.position);
+    }
+    if (!std::is_sorted(positions.cbegin(), positions.cend())) {
+        std::sort(positions.begin(), positions.end());
+    }
+    if (track_type != SightRead::TrackType::Drums) {
+        positions.erase(std::unique(positions.begin(), positions.end()),
+                        positions.end());
+    }
+
+    for (auto [start, end] : solo_ranges) {
+        const auto first
+            = std::lower_bound(positions.cbegin(), positions.cend(), start);
+        const auto last = is_midi
+            ? std::lower_bound(first, positions.cend(), end)
+            : std::upper_bound(first, positions.cend(), end);
+        const auto note_count = static_cast<int>(std::distance(first, last));
+        if (note_count == 0) {
             continue;
         }
-        if (track_type != SightRead::TrackType::Drums) {
-            note_count = static_cast<int>(positions_in_solo.size());
-        }
         solos.push_back({start, end, SOLO_NOTE_VALUE * note_count});
     }
 
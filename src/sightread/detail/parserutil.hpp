@@ -1,6 +1,8 @@
 #ifndef SIGHTREAD_DETAIL_PARSERUTIL_HPP
 #define SIGHTREAD_DETAIL_PARSERUTIL_HPP
 
+#include <optional>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
@@ -10,6 +12,11 @@
 namespace SightRead::Detail {
 bool is_six_fret_instrument(SightRead::Instrument instrument);
 
+// Returns the difficulty and instrument of a .chart section header such as
+// "ExpertSingle", or std::nullopt if it is not an instrument section.
+std::optional<std::tuple<SightRead::Difficulty, SightRead::Instrument>>
+diff_inst_from_header(std::string_view header);
+
 // Takes a sequence of points where some note type/event is turned on, and a
 // sequence where said type is turned off, and returns a tuple of intervals
 // where the event is on.
@@ -17,11 +24,14 @@ std::vector<std::tuple<SightRead::Tick, SightRead::Tick>>
 combine_solo_events(const std::vector<int>& on_events,
                     const std::vector<int>& off_events);
 
-std::vector<SightRead::Solo>
-form_solo_vector(const std::vector<int>& solo_on_events,
-                 const std::vector<int>& solo_off_events,
-                 const std::vector<SightRead::Note>& notes,
-                 SightRead::TrackType track_type, bool is_midi);
+// Returns the solos for the ranges from combine_solo_events that contain at
+// least one note. The ranges do not depend on the notes, so they can be
+// combined once and shared between difficulties.
+std::vector<SightRead::Solo> form_solo_vector(
+    const std::vector<std::tuple<SightRead::Tick, SightRead::Tick>>&
+        solo_ranges,
+    const std::vector<SightRead::Note>& notes, SightRead::TrackType track_type,
+    bool is_midi);
 }
 
 #endif
@@ -0,0 +1,85 @@
+#ifndef SIGHTREAD_DETAIL_PERFECTHASH_HPP
+#define SIGHTREAD_DETAIL_PERFECTHASH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+
+namespace SightRead::Detail {
+// A map from a fixed set of names to values, meant to be built as a constexpr
+// variable. The constructor searches for a hash seed under which no two names
+// share a slot, so a lookup is one hash and one string comparison, and a name
+// that is not in the map is rejected without allocating. The names must be
+// distinct and TableSize must be a power of two; a table a few times larger
+// than the number of names keeps the seed search short.
+template <typename Value, std::size_t NameCount, std::size_t TableSize>
+class PerfectHashMap {
+private:
+    static_assert(TableSize >= NameCount);
+    static_assert((TableSize & (TableSize - 1)) == 0);
+
+    struct Slot {
+        std::string_view name;
+        Value value {};
+        bool is_used {false};
+    };
+
+    std::array<Slot, TableSize> m_slots {};
+    std::uint32_t m_seed {0};
+
+    static constexpr std::size_t slot_index(std::string_view name,
+                                            std::uint32_t seed)
+    {
+        // FNV-1a, with the seed mixed into the offset basis.
+        constexpr std::uint32_t FNV_OFFSET_BASIS = 2166136261U;
+        constexpr std::uint32_t FNV_PRIME = 16777619U;
+
+        auto hash = FNV_OFFSET_BASIS ^ seed;
+        for (auto c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= FNV_PRIME;
+        }
+        return hash & (TableSize - 1);
+    }
+
+    constexpr bool try_seed(
+        const std::array<std::tuple<std::string_view, Value>, NameCount>&
+            entries,
+        std::uint32_t seed)
+    {
+        m_slots = {};
+        m_seed = seed;
+        for (const auto& [name, value] : entries) {
+            auto& slot = m_slots.at(slot_index(name, seed));
+            if (slot.is_used) {
+                return false;
+            }
+            slot = {name, value, true};
+        }
+        return true;
+    }
+
+public:
+    constexpr explicit PerfectHashMap(
+        const std::array<std::tuple<std::string_view, Value>, NameCount>&
+            entries)
+    {
+        for (std::uint32_t seed = 0; !try_seed(entries, seed); ++seed) { }
+    }
+
+    [[nodiscard]] constexpr std::optional<Value>
+    find(std::string_view name) const
+    {
+        const auto& slot = m_slots.at(slot_index(name, m_seed));
+        if (!slot.is_used || slot.name != name) {
+            return std::nullopt;
+        }
+        return slot.value;
+    }
+};
+}
+
+#endif
@@ -0,0 +1,188 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "sightread/detail/textencoding.hpp"
+
+namespace {
+constexpr std::size_t BLOCK_UNITS = 8;
+constexpr std::size_t BLOCK_BYTES = 2 * BLOCK_UNITS;
+
+// Byte masks with a bit set wherever an ASCII code unit must be zero. These
+// are built from byte arrays so they work whatever the native endianness.
+std::uint64_t non_ascii_mask(bool is_big_endian)
+{
+    constexpr std::uint8_t LOW_BYTE_MASK = 0x80;
+    constexpr std::uint8_t HIGH_BYTE_MASK = 0xFF;
+
+    std::array<std::uint8_t, sizeof(std::uint64_t)> bytes {};
+    for (auto i = 0U; i < bytes.size(); i += 2) {
+        bytes.at(i) = is_big_endian ? HIGH_BYTE_MASK : LOW_BYTE_MASK;
+        bytes.at(i + 1) = is_big_endian ? LOW_BYTE_MASK : HIGH_BYTE_MASK;
+    }
+    std::uint64_t mask = 0;
+    std::memcpy(&mask, bytes.data(), sizeof(mask));
+    return mask;
+}
+
+class Utf16Transcoder {
+private:
+    std::string_view m_data;
+    bool m_is_big_endian;
+    std::string m_output;
+
+    [[nodiscard]] char32_t unit(std::size_t index) const
+    {
+        constexpr int BYTE_BITS = 8;
+
+        const auto first = static_cast<std::uint8_t>(m_data[2 * index]);
+        const auto second = static_cast<std::uint8_t>(m_data[2 * index + 1]);
+        if (m_is_big_endian) {
+            return static_cast<char32_t>(first << BYTE_BITS | second);
+        }
+        return static_cast<char32_t>(second << BYTE_BITS | first);
+    }
+
+    void append(char32_t code_point)
+    {
+        constexpr char32_t ONE_BYTE_LIMIT = 0x80;
+        constexpr char32_t TWO_BYTE_LIMIT = 0x800;
+        constexpr char32_t THREE_BYTE_LIMIT = 0x10000;
+        constexpr char32_t CONTINUATION_BITS = 0x3F;
+        constexpr char32_t CONTINUATION_PREFIX = 0x80;
+        constexpr char32_t TWO_BYTE_PREFIX = 0xC0;
+        constexpr char32_t THREE_BYTE_PREFIX = 0xE0;
+        constexpr char32_t FOUR_BYTE_PREFIX = 0xF0;
+        constexpr int SIX_BITS = 6;
+        constexpr int TWELVE_BITS = 12;
+        constexpr int EIGHTEEN_BITS = 18;
+
+        const auto continuation = [&](int shift) {
+            return static_cast<char>(
+                ((code_point >> shift) & CONTINUATION_BITS)
+                | CONTINUATION_PREFIX);
+        };
+
+        if (code_point < ONE_BYTE_LIMIT) {
+            m_output.push_back(static_cast<char>(code_point));
+        } else if (code_point < TWO_BYTE_LIMIT) {
+            m_output.push_back(
+                static_cast<char>((code_point >> SIX_BITS) | TWO_BYTE_PREFIX));
+            m_output.push_back(continuation(0));
+        } else if (code_point < THREE_BYTE_LIMIT) {
+            m_output.push_back(static_cast<char>((code_point >> TWELVE_BITS)
+                                                 | THREE_BYTE_PREFIX));
+            m_output.push_back(continuation(SIX_BITS));
+            m_output.push_back(continuation(0));
+        } else {
+            m_output.push_back(static_cast<char>((code_point >> EIGHTEEN_BITS)
+                                                 | FOUR_BYTE_PREFIX));
+            m_output.push_back(continuation(TWELVE_BITS));
+            m_output.push_back(continuation(SIX_BITS));
+            m_output.push_back(continuation(0));
+        }
+    }
+
+    // Copies the block of eight code units starting at index if they are all
+    // ASCII, returning whether it did. The check is done on two 64-bit words
+    // and the copy is a fixed-length loop, both of which compilers vectorise.
+    bool append_ascii_block(std::size_t index, std::uint64_t mask)
+    {
+        std::array<std::uint64_t, 2> words {};
+        std::memcpy(words.data(), m_data.data() + 2 * index, BLOCK_BYTES);
+        if (((words[0] | words[1]) & mask) != 0) {
+            return false;
+        }
+        const auto low_byte_offset = m_is_big_endian ? 1U : 0U;
+        std::array<char, BLOCK_UNITS> block {};
+        for (auto i = 0U; i < BLOCK_UNITS; ++i) {
+            block.at(i) = m_data[2 * (index + i) + low_byte_offset];
+        }
+        m_output.append(block.data(), block.size());
+        return true;
+    }
+
+public:
+    Utf16Transcoder(std::string_view data, bool is_big_endian)
+        : m_data {data}
+        , m_is_big_endian {is_big_endian}
+    {
+    }
+
+    std::string transcode() &&
+    {
+        constexpr char32_t HIGH_SURROGATE_START = 0xD800;
+        constexpr char32_t LOW_SURROGATE_START = 0xDC00;
+        constexpr char32_t SURROGATE_END = 0xE000;
+        constexpr char32_t SURROGATE_BITS = 0x3FF;
+        constexpr char32_t SUPPLEMENTARY_START = 0x10000;
+        constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+        constexpr int SURROGATE_SHIFT = 10;
+
+        const auto unit_count = m_data.size() / 2;
+        const auto mask = non_ascii_mask(m_is_big_endian);
+        m_output.reserve(unit_count);
+
+        std::size_t i = 0;
+        while (i < unit_count) {
+            if (i + BLOCK_UNITS <= unit_count && append_ascii_block(i, mask)) {
+                i += BLOCK_UNITS;
+                continue;
+            }
+            const auto code_unit = unit(i);
+            ++i;
+            if (code_unit < HIGH_SURROGATE_START
+                || code_unit >= SURROGATE_END) {
+                append(code_unit);
+                continue;
+            }
+            if (code_unit < LOW_SURROGATE_START && i < unit_count) {
+                const auto next_unit = unit(i);
+                if (next_unit >= LOW_SURROGATE_START
+                    && next_unit < SURROGATE_END) {
+                    ++i;
+                    append(SUPPLEMENTARY_START
+                           + ((code_unit & SURROGATE_BITS) << SURROGATE_SHIFT)
+                           + (next_unit & SURROGATE_BITS));
+                    continue;
+                }
+            }
+            append(REPLACEMENT_CHARACTER);
+        }
+        if (m_data.size() % 2 != 0) {
+            append(REPLACEMENT_CHARACTER);
+        }
+
+        return std::move(m_output);
+    }
+};
+}
+
+std::optional<std::string>
+SightRead::Detail::transcode_utf16(std::string_view data)
+{
+    constexpr std::string_view UTF16_LE_BOM {"\xFF\xFE"};
+    constexpr std::string_view UTF16_BE_BOM {"\xFE\xFF"};
+
+    if (data.starts_with(UTF16_LE_BOM)) {
+        return Utf16Transcoder {data.substr(UTF16_LE_BOM.size()), false}
+            .transcode();
+    }
+    if (data.starts_with(UTF16_BE_BOM)) {
+        return Utf16Transcoder {data.substr(UTF16_BE_BOM.size()), true}
+            .transcode();
+    }
+    return std::nullopt;
+}
+
+std::string_view SightRead::Detail::skip_utf8_bom(std::string_view data)
+{
+    constexpr std::string_view UTF8_BOM {"\xEF\xBB\xBF"};
+
+    if (data.starts_with(UTF8_BOM)) {
+        data.remove_prefix(UTF8_BOM.size());
+    }
+    return data;
+}
@@ -0,0 +1,18 @@
+#ifndef SIGHTREAD_DETAIL_TEXTENCODING_HPP
+#define SIGHTREAD_DETAIL_TEXTENCODING_HPP
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace SightRead::Detail {
+// If data starts with a UTF-16LE or UTF-16BE BOM, returns the rest of data
+// transcoded to UTF-8, with unpaired surrogates and a trailing odd byte
+// replaced by U+FFFD. Otherwise returns std::nullopt.
+std::optional<std::string> transcode_utf16(std::string_view data);
+
+// Returns data without its leading UTF-8 BOM, if it has one.
+std::string_view skip_utf8_bom(std::string_view data);
+}
+
+#endif
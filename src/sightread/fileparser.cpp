@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "sightread/chartparser.hpp"
+#include "sightread/detail/mappedfile.hpp"
+#include "sightread/fileparser.hpp"
+#include "sightread/midiparser.hpp"
+
+namespace {
+template <std::size_t N>
+bool starts_with(std::span<const std::uint8_t> data,
+                 const std::array<std::uint8_t, N>& prefix)
+{
+    return data.size() >= N
+        && std::equal(prefix.cbegin(), prefix.cend(), data.begin());
+}
+}
+
+SightRead::Song SightRead::parse_file(const std::filesystem::path& path,
+                                      const SightRead::ParseOptions& options)
+{
+    constexpr std::array<std::uint8_t, 4> MIDI_MAGIC {{'M', 'T', 'h', 'd'}};
+
+    const SightRead::Detail::MappedFile file {path};
+    const auto data = file.bytes();
+
+    if (starts_with(data, MIDI_MAGIC)) {
+        return SightRead::MidiParser(options.metadata)
+            .hopo_threshold(options.hopo_threshold)
+            .permit_instruments(options.permitted_instruments)
+            .parse_solos(options.permit_solos)
+            .worker_threads(options.worker_threads)
+            .parse(data);
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const std::string_view chart_data {reinterpret_cast<const char*>(
+                                           data.data()),
+                                       data.size()};
+    return SightRead::ChartParser(options.metadata)
+        .hopo_threshold(options.hopo_threshold)
+        .permit_instruments(options.permitted_instruments)
+        .parse_solos(options.permit_solos)
+        .worker_threads(options.worker_threads)
+        .parse(chart_data);
+}
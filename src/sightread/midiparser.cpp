@@ -1,3 +1,4 @@
+#include <string_view>
 #include <utility>
 
 #include "sightread/detail/midiconverter.hpp"
@@ -9,6 +10,7 @@ SightRead::MidiParser::MidiParser(SightRead::Metadata metadata)
                         SightRead::Tick {0}}
     , m_permitted_instruments {SightRead::all_instruments()}
     , m_permit_solos {true}
+    , m_worker_threads {1}
 {
 }
 
@@ -32,14 +34,24 @@ SightRead::MidiParser& SightRead::MidiParser::parse_solos(bool permit_solos)
     return *this;
 }
 
+SightRead::MidiParser&
+SightRead::MidiParser::worker_threads(unsigned int thread_count)
+{
+    m_worker_threads = thread_count;
+    return *this;
+}
+
 SightRead::Song
 SightRead::MidiParser::parse(std::span<const std::uint8_t> data) const
 {
-    const auto midi = SightRead::Detail::parse_midi(data);
-
     const auto converter = SightRead::Detail::MidiConverter(m_metadata)
                                .hopo_threshold(m_hopo_threshold)
                                .permit_instruments(m_permitted_instruments)
-                               .parse_solos(m_permit_solos);
+                               .parse_solos(m_permit_solos)
+                               .worker_threads(m_worker_threads);
+    const auto midi = SightRead::Detail::parse_midi(
+        data, m_worker_threads, [&](std::string_view track_name) {
+            return converter.is_track_needed(track_name);
+        });
     return converter.convert(midi);
 }
\ No newline at end of file
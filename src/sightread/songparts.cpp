@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include <stdexcept>
 #include <tuple>
 
@@ -34,6 +35,32 @@ bool is_chord(const SightRead::Note& note)
     }
     return count >= 2;
 }
+
+// prev_note is the note before note in the track after merging, or nullptr if
+// note is the first.
+void set_hopo_flag(SightRead::Note& note, const SightRead::Note* prev_note,
+                   SightRead::Tick max_hopo_gap)
+{
+    if ((note.flags & (SightRead::FLAGS_TAP | SightRead::FLAGS_FORCE_STRUM))
+        != 0U) {
+        return;
+    }
+    bool is_hopo = (note.flags & SightRead::FLAGS_FORCE_FLIP) != 0U;
+    if (prev_note != nullptr) {
+        const auto note_gap = note.position - prev_note->position;
+        if (!is_chord(note) && note.colours() != prev_note->colours()
+            && note_gap <= max_hopo_gap) {
+            is_hopo = !is_hopo;
+        }
+    }
+    if ((note.flags & SightRead::FLAGS_FORCE_HOPO) != 0U) {
+        is_hopo = true;
+    }
+    if (is_hopo) {
+        note.flags = static_cast<SightRead::NoteFlags>(
+            note.flags | SightRead::FLAGS_HOPO);
+    }
+}
 }
 
 namespace SightRead {
@@ -70,6 +97,24 @@ int SightRead::Note::colours() const
     return colour_flags;
 }
 
+SightRead::Tick SightRead::Note::sustain_ticks() const
+{
+    // Unused lanes are masked out rather than skipped so the loop has no
+    // branches to mispredict.
+    auto min_length = std::numeric_limits<int>::max();
+    auto max_length = std::numeric_limits<int>::min();
+    auto total_length = 0;
+    for (auto length : lengths) {
+        const auto value = length.value();
+        const auto is_used = value != -1;
+        min_length = std::min(min_length, is_used ? value : min_length);
+        max_length = std::max(max_length, is_used ? value : max_length);
+        total_length += is_used ? value : 0;
+    }
+    return SightRead::Tick {min_length == max_length ? min_length
+                                                     : total_length};
+}
+
 void SightRead::Note::merge_non_opens_into_open()
 {
     const auto index = open_index();
@@ -113,25 +158,16 @@ bool SightRead::Note::is_skipped_kick(
 
 void SightRead::NoteTrack::compute_base_score_ticks()
 {
-    constexpr int BASE_SUSTAIN_DENSITY = 25;
-
     SightRead::Tick total_ticks {0};
     for (const auto& note : m_notes) {
-        std::vector<SightRead::Tick> constituent_lengths;
-        for (auto length : note.lengths) {
-            if (length != SightRead::Tick {-1}) {
-                constituent_lengths.push_back(length);
-            }
-        }
-        std::sort(constituent_lengths.begin(), constituent_lengths.end());
-        if (constituent_lengths.front() == constituent_lengths.back()) {
-            total_ticks += constituent_lengths.front();
-        } else {
-            for (auto length : constituent_lengths) {
-                total_ticks += length;
-            }
-        }
+        total_ticks += note.sustain_ticks();
     }
+    set_base_score_ticks(total_ticks);
+}
+
+void SightRead::NoteTrack::set_base_score_ticks(SightRead::Tick total_ticks)
+{
+    constexpr int BASE_SUSTAIN_DENSITY = 25;
 
     const auto resolution = m_global_data->resolution();
     m_base_score_ticks
@@ -157,33 +193,58 @@ void SightRead::NoteTrack::merge_same_time_notes()
     m_notes = std::move(notes);
 }
 
-void SightRead::NoteTrack::add_hopos(SightRead::Tick max_hopo_gap)
+// Does in one pass over the sorted notes what would otherwise be separate
+// passes: consecutive notes with the same position and colours are replaced by
+// the last of them, other notes at the same position are merged into chords
+// (except on drums), and each resulting note adds to the base score before its
+// open note merging and HOPO flag are done. The notes are compacted in place.
+void SightRead::NoteTrack::build_notes(SightRead::Tick max_hopo_gap)
 {
-    if (m_track_type == TrackType::Drums) {
-        return;
-    }
+    const auto is_drums = m_track_type == TrackType::Drums;
+    SightRead::Tick total_ticks {0};
 
-    for (auto i = 0U; i < m_notes.size(); ++i) {
-        if ((m_notes[i].flags & (FLAGS_TAP | FLAGS_FORCE_STRUM)) != 0U) {
-            continue;
+    auto output = m_notes.begin();
+    const auto finish_note = [&](SightRead::Note note) {
+        total_ticks += note.sustain_ticks();
+        // We handle open note merging after the base score because in v23 the
+        // removed notes still affect the base score.
+        note.merge_non_opens_into_open();
+        if (!is_drums) {
+            const auto* prev_note
+                = output == m_notes.begin() ? nullptr : &*(output - 1);
+            set_hopo_flag(note, prev_note, max_hopo_gap);
         }
-        bool is_hopo = (m_notes[i].flags & FLAGS_FORCE_FLIP) != 0U;
-        if (i != 0U) {
-            const auto note_gap = m_notes[i].position - m_notes[i - 1].position;
-            if (!is_chord(m_notes[i])
-                && m_notes[i].colours() != m_notes[i - 1].colours()
-                && note_gap <= max_hopo_gap) {
-                is_hopo = !is_hopo;
-            }
+        *output = note;
+        ++output;
+    };
+
+    for (auto p = m_notes.begin(); p < m_notes.end();) {
+        auto q = p + 1;
+        while (q < m_notes.end() && q->position == p->position) {
+            ++q;
         }
-        if ((m_notes[i].flags & FLAGS_FORCE_HOPO) != 0U) {
-            is_hopo = true;
+        // Written entries trail the read position, so the deduplicated notes
+        // of a position can be compacted to the front of its range.
+        auto deduped_end = p;
+        for (auto r = p; r < q; ++r) {
+            if (r + 1 < q && (r + 1)->colours() == r->colours()) {
+                continue;
+            }
+            *deduped_end = *r;
+            ++deduped_end;
         }
-        if (is_hopo) {
-            m_notes[i].flags
-                = static_cast<NoteFlags>(m_notes[i].flags | FLAGS_HOPO);
+        if (is_drums) {
+            for (auto r = p; r < deduped_end; ++r) {
+                finish_note(*r);
+            }
+        } else {
+            finish_note(combined_note(p, deduped_end));
         }
+        p = q;
     }
+
+    m_notes.erase(output, m_notes.end());
+    set_base_score_ticks(total_ticks);
 }
 
 SightRead::NoteTrack::NoteTrack(std::vector<Note> notes,
@@ -199,22 +260,15 @@ SightRead::NoteTrack::NoteTrack(std::vector<Note> notes,
         throw std::runtime_error("Non-null global data required");
     }
 
-    std::stable_sort(notes.begin(), notes.end(),
-                     [](const auto& lhs, const auto& rhs) {
-                         return lhs.position < rhs.position;
-                     });
-
-    if (!notes.empty()) {
-        auto prev_note = notes.cbegin();
-        for (auto p = notes.cbegin() + 1; p < notes.cend(); ++p) {
-            if (p->position != prev_note->position
-                || p->colours() != prev_note->colours()) {
-                m_notes.push_back(*prev_note);
-            }
-            prev_note = p;
-        }
-        m_notes.push_back(*prev_note);
+    // Converters nearly always produce notes in order already.
+    const auto by_position = [](const auto& lhs, const auto& rhs) {
+        return lhs.position < rhs.position;
+    };
+    if (!std::is_sorted(notes.cbegin(), notes.cend(), by_position)) {
+        std::stable_sort(notes.begin(), notes.end(), by_position);
     }
+    m_notes = std::move(notes);
+    build_notes(max_hopo_gap);
 
     std::vector<SightRead::Tick> sp_starts;
     std::vector<SightRead::Tick> sp_ends;
@@ -251,17 +305,6 @@ SightRead::NoteTrack::NoteTrack(std::vector<Note> notes,
             m_sp_phrases.push_back(phrase);
         }
     }
-
-    merge_same_time_notes();
-    compute_base_score_ticks();
-
-    // We handle open note merging at the end because in v23 the removed
-    // notes still affect the base score.
-    for (auto& note : m_notes) {
-        note.merge_non_opens_into_open();
-    }
-
-    add_hopos(max_hopo_gap);
 }
 
 void SightRead::NoteTrack::generate_drum_fills(
@@ -139,6 +139,38 @@ BOOST_AUTO_TEST_CASE(bad_values_are_ignored)
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(chart_text_encodings)
+
+BOOST_AUTO_TEST_CASE(utf16le_charts_are_read)
+{
+    const auto header = header_string({{"Resolution", "200"}});
+    const auto guitar_track = section_string("ExpertSingle", {{768, 0, 0}});
+    const auto utf8_file = header + '\n' + guitar_track;
+    std::string chart_file {"\xFF\xFE"};
+    for (auto c : utf8_file) {
+        chart_file.push_back(c);
+        chart_file.push_back('\0');
+    }
+
+    const auto song = SightRead::ChartParser({}).parse(chart_file);
+
+    BOOST_CHECK_EQUAL(song.global_data().resolution(), 200);
+    BOOST_CHECK_EQUAL(song.instruments().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(utf8_bom_is_skipped)
+{
+    const auto header = header_string({{"Resolution", "200"}});
+    const auto guitar_track = section_string("ExpertSingle", {{768, 0, 0}});
+    const auto chart_file = "\xEF\xBB\xBF" + header + '\n' + guitar_track;
+
+    const auto song = SightRead::ChartParser({}).parse(chart_file);
+
+    BOOST_CHECK_EQUAL(song.global_data().resolution(), 200);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_CASE(chart_header_values_besides_resolution_are_discarded)
 {
     const auto header = header_string({{"Name", "\"TestName\""},
@@ -689,6 +721,58 @@ BOOST_AUTO_TEST_CASE(instruments_not_permitted_are_dropped_from_charts)
                                   expected_instruments.cend());
 }
 
+BOOST_AUTO_TEST_CASE(charts_are_read_the_same_with_worker_threads)
+{
+    const auto guitar_track = section_string("ExpertSingle", {{768, 0, 0}});
+    const auto bass_track
+        = section_string("ExpertDoubleBass", {{192, 0, 0}, {384, 1, 0}});
+    const auto chart_file = guitar_track + '\n' + bass_track;
+
+    const auto song = SightRead::ChartParser({}).parse(chart_file);
+    const auto parallel_song
+        = SightRead::ChartParser({}).worker_threads(4).parse(chart_file);
+    const auto& notes = song.track(SightRead::Instrument::Bass,
+                                   SightRead::Difficulty::Expert)
+                            .notes();
+    const auto& parallel_notes
+        = parallel_song
+              .track(SightRead::Instrument::Bass,
+                     SightRead::Difficulty::Expert)
+              .notes();
+
+    BOOST_CHECK_EQUAL(parallel_song.instruments().size(),
+                      song.instruments().size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(parallel_notes.cbegin(),
+                                  parallel_notes.cend(), notes.cbegin(),
+                                  notes.cend());
+}
+
+BOOST_AUTO_TEST_CASE(
+    sections_before_song_use_default_resolution_with_worker_threads)
+{
+    const auto guitar_track
+        = section_string("ExpertSingle", {{0, 0, 0}, {100, 1, 0}});
+    const auto header = header_string({{"Resolution", "480"}});
+    const auto bass_track
+        = section_string("ExpertDoubleBass", {{0, 0, 0}, {100, 1, 0}});
+    const auto chart_file = guitar_track + '\n' + header + '\n' + bass_track;
+
+    const auto song
+        = SightRead::ChartParser({}).worker_threads(4).parse(chart_file);
+    const auto& guitar_notes = song.track(SightRead::Instrument::Guitar,
+                                          SightRead::Difficulty::Expert)
+                                   .notes();
+    const auto& bass_notes = song.track(SightRead::Instrument::Bass,
+                                        SightRead::Difficulty::Expert)
+                                 .notes();
+
+    BOOST_REQUIRE_EQUAL(guitar_notes.size(), 2);
+    BOOST_REQUIRE_EQUAL(bass_notes.size(), 2);
+    BOOST_CHECK_EQUAL(guitar_notes[1].flags, SightRead::FLAGS_FIVE_FRET_GUITAR);
+    BOOST_CHECK_EQUAL(bass_notes[1].flags,
+                      SightRead::FLAGS_HOPO | SightRead::FLAGS_FIVE_FRET_GUITAR);
+}
+
 BOOST_AUTO_TEST_CASE(solos_ignored_from_charts_if_not_permitted)
 {
     const auto chart_file = section_string(
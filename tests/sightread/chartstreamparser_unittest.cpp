@@ -0,0 +1,82 @@
+#include <string>
+#include <string_view>
+
+#include <boost/test/unit_test.hpp>
+
+#include "sightread/chartparser.hpp"
+#include "sightread/chartstreamparser.hpp"
+#include "sightread/tempomap.hpp"
+#include "testhelpers.hpp"
+
+namespace {
+const std::string_view CHART_TEXT
+    = "[Song]\r\n{\r\n  Resolution = 480\r\n}\r\n\r\n  [ExpertSingle]\r\n"
+      "{\r\n  768 = N 0 0\r\n  960 = N 1 100\r\n}\r\n[ExpertDoubleBass]\r\n"
+      "{\r\n  768 = N 2 0\r\n}";
+
+SightRead::Song stream_in_chunks(std::string_view text, std::size_t chunk_size)
+{
+    SightRead::ChartStreamParser parser {{}};
+    for (std::size_t i = 0; i < text.size(); i += chunk_size) {
+        parser.push(text.substr(i, chunk_size));
+    }
+    return parser.finish();
+}
+}
+
+BOOST_AUTO_TEST_CASE(streamed_charts_match_whole_charts_for_any_chunk_size)
+{
+    const auto expected_song = SightRead::ChartParser({}).parse(CHART_TEXT);
+    const auto& expected_notes
+        = expected_song
+              .track(SightRead::Instrument::Guitar,
+                     SightRead::Difficulty::Expert)
+              .notes();
+
+    for (std::size_t chunk_size = 1; chunk_size <= CHART_TEXT.size();
+         ++chunk_size) {
+        const auto song = stream_in_chunks(CHART_TEXT, chunk_size);
+        const auto& notes = song.track(SightRead::Instrument::Guitar,
+                                       SightRead::Difficulty::Expert)
+                                .notes();
+
+        BOOST_CHECK_EQUAL(song.global_data().resolution(), 480);
+        BOOST_CHECK_EQUAL(song.instruments().size(), 2);
+        BOOST_CHECK_EQUAL_COLLECTIONS(notes.cbegin(), notes.cend(),
+                                      expected_notes.cbegin(),
+                                      expected_notes.cend());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(utf8_bom_split_across_chunks_is_skipped)
+{
+    const auto text = "\xEF\xBB\xBF" + std::string {CHART_TEXT};
+
+    const auto song = stream_in_chunks(text, 1);
+
+    BOOST_CHECK_EQUAL(song.global_data().resolution(), 480);
+}
+
+BOOST_AUTO_TEST_CASE(utf16_streams_throw)
+{
+    SightRead::ChartStreamParser parser {{}};
+
+    BOOST_CHECK_THROW(parser.push("\xFF\xFE[\0"), SightRead::ParseError);
+}
+
+BOOST_AUTO_TEST_CASE(malformed_sections_throw_while_streaming)
+{
+    SightRead::ChartStreamParser parser {{}};
+
+    BOOST_CHECK_THROW(parser.push("[Song]\nResolution = 480\n"),
+                      SightRead::ParseError);
+}
+
+BOOST_AUTO_TEST_CASE(unfinished_sections_throw_on_finish)
+{
+    SightRead::ChartStreamParser parser {{}};
+    parser.push("[ExpertSingle]\n{\n768 = N 0 0\n");
+
+    BOOST_CHECK_THROW([&] { return parser.finish(); }(),
+                      SightRead::ParseError);
+}
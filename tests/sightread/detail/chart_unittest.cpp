@@ -1,4 +1,6 @@
+#include <string_view>
 #include <tuple>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -116,6 +118,26 @@ BOOST_AUTO_TEST_CASE(key_value_pairs_are_read)
     BOOST_CHECK_EQUAL(section.key_value_pairs.at("Key2"), "Value2");
 }
 
+BOOST_AUTO_TEST_CASE(last_value_of_repeated_key_is_kept)
+{
+    const char* text = "[Section]\n{\nKey = Value\nKey2 = A\nKey = Value2\n}";
+
+    const auto section = SightRead::Detail::parse_chart(text).sections[0];
+
+    BOOST_CHECK_EQUAL(section.key_value_pairs.size(), 2);
+    BOOST_CHECK_EQUAL(section.key_value_pairs.at("Key"), "Value2");
+    BOOST_CHECK(!section.key_value_pairs.find("Key3").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(values_are_rest_of_line_without_trailing_spaces)
+{
+    const char* text = "[Song]\n{\nName = \"Song Name\"  \n}";
+
+    const auto section = SightRead::Detail::parse_chart(text).sections[0];
+
+    BOOST_CHECK_EQUAL(section.key_value_pairs.at("Name"), "\"Song Name\"");
+}
+
 BOOST_AUTO_TEST_CASE(note_events_are_read)
 {
     const char* text = "[Section]\n{\n1000 = N 1 0\n}";
@@ -136,6 +158,54 @@ BOOST_AUTO_TEST_CASE(note_events_with_extra_spaces_throw)
                       SightRead::ParseError);
 }
 
+BOOST_AUTO_TEST_CASE(note_events_with_extra_fields_are_read)
+{
+    const char* text = "[Section]\n{\n1000 = N 1 0 12\n}";
+    const std::vector<SightRead::Detail::NoteEvent> events {{1000, 1, 0}};
+
+    const auto section = SightRead::Detail::parse_chart(text).sections[0];
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(section.note_events.cbegin(),
+                                  section.note_events.cend(), events.cbegin(),
+                                  events.cend());
+}
+
+BOOST_AUTO_TEST_CASE(negative_and_long_numbers_are_read)
+{
+    const char* text
+        = "[Section]\n{\n-5 = N 1 -0\n2000000000 = N 00000000001 -12345678\n}";
+    const std::vector<SightRead::Detail::NoteEvent> events {
+        {-5, 1, 0}, {2000000000, 1, -12345678}};
+
+    const auto section = SightRead::Detail::parse_chart(text).sections[0];
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(section.note_events.cbegin(),
+                                  section.note_events.cend(), events.cbegin(),
+                                  events.cend());
+}
+
+BOOST_AUTO_TEST_CASE(note_events_with_bad_numbers_throw)
+{
+    BOOST_CHECK_THROW(
+        [&] {
+            return SightRead::Detail::parse_chart(
+                "[Section]\n{\n768 = N 1: 0\n}");
+        }(),
+        SightRead::ParseError);
+    BOOST_CHECK_THROW(
+        [&] {
+            return SightRead::Detail::parse_chart(
+                "[Section]\n{\n768 = N 1 /0\n}");
+        }(),
+        SightRead::ParseError);
+    BOOST_CHECK_THROW(
+        [&] {
+            return SightRead::Detail::parse_chart(
+                "[Section]\n{\n768 = N 1 2147483648\n}");
+        }(),
+        SightRead::ParseError);
+}
+
 BOOST_AUTO_TEST_CASE(bpm_events_are_read)
 {
     const char* text = "[Section]\n{\n1000 = B 150000\n}";
@@ -218,3 +288,184 @@ BOOST_AUTO_TEST_CASE(short_mid_section_lines_throw)
         }(),
         SightRead::ParseError);
 }
+
+BOOST_AUTO_TEST_SUITE(chart_line_index)
+
+BOOST_AUTO_TEST_CASE(lines_are_split_on_newlines)
+{
+    const SightRead::Detail::ChartLineIndex index {
+        "Alpha\r\nBeta\nGamma\rDelta"};
+
+    BOOST_CHECK_EQUAL(index.size(), 3);
+    BOOST_CHECK_EQUAL(index.line(0), "Alpha");
+    BOOST_CHECK_EQUAL(index.line(1), "Beta");
+    BOOST_CHECK_EQUAL(index.line(2), "Gamma\rDelta");
+}
+
+BOOST_AUTO_TEST_CASE(leading_whitespace_is_only_kept_on_first_line)
+{
+    const SightRead::Detail::ChartLineIndex index {"  Alpha\n \t Beta"};
+
+    BOOST_CHECK_EQUAL(index.line(0), "  Alpha");
+    BOOST_CHECK_EQUAL(index.line(1), "Beta");
+}
+
+BOOST_AUTO_TEST_CASE(line_numbers_are_correct)
+{
+    const SightRead::Detail::ChartLineIndex index {"A\nB\n\nC"};
+
+    BOOST_CHECK_EQUAL(index.line_number(0), 1);
+    BOOST_CHECK_EQUAL(index.line_number(2), 2);
+    BOOST_CHECK_EQUAL(index.line_number(3), 2);
+    BOOST_CHECK_EQUAL(index.line_number(4), 3);
+    BOOST_CHECK_EQUAL(index.line_number(5), 4);
+}
+
+BOOST_AUTO_TEST_CASE(section_offsets_are_correct)
+{
+    const SightRead::Detail::ChartLineIndex index {
+        "[A]\n{\n}\n\n[B]\r\n{\r\n1 = N 0 0\r\n}\r\n"};
+    const std::vector<std::size_t> offsets {0, 9};
+
+    const auto section_offsets = index.section_offsets();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(section_offsets.cbegin(),
+                                  section_offsets.cend(), offsets.cbegin(),
+                                  offsets.cend());
+}
+
+BOOST_AUTO_TEST_CASE(unterminated_sections_have_no_offset)
+{
+    const SightRead::Detail::ChartLineIndex index {"[A]\n{\n}\n[B]\n{\n"};
+    const std::vector<std::size_t> offsets {0};
+
+    const auto section_offsets = index.section_offsets();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(section_offsets.cbegin(),
+                                  section_offsets.cend(), offsets.cbegin(),
+                                  offsets.cend());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(unpermitted_instruments)
+
+BOOST_AUTO_TEST_CASE(unpermitted_instrument_sections_are_skipped)
+{
+    const char* text
+        = "[Song]\n{\nResolution = 192\n}\n[ExpertDrums]\n{\n768 = N  0 0\n}\n"
+          "[ExpertSingle]\n{\n768 = N 0 0\n}";
+
+    const auto chart = SightRead::Detail::parse_chart(
+        text, {SightRead::Instrument::Guitar});
+
+    BOOST_CHECK_EQUAL(chart.sections.size(), 2);
+    BOOST_CHECK_EQUAL(chart.sections[0].name, "Song");
+    BOOST_CHECK_EQUAL(chart.sections[1].name, "ExpertSingle");
+}
+
+BOOST_AUTO_TEST_CASE(unfinished_skipped_sections_still_throw)
+{
+    const char* text = "[ExpertDrums]\n{\n768 = N 0 0\n";
+
+    BOOST_CHECK_THROW(
+        [&] {
+            return SightRead::Detail::parse_chart(
+                text, {SightRead::Instrument::Guitar});
+        }(),
+        SightRead::ParseError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(parallel_lexing)
+
+BOOST_AUTO_TEST_CASE(sections_are_in_file_order)
+{
+    const char* text = "[Song]\n{\nResolution = 192\n}\n[ExpertSingle]\n{\n768 "
+                       "= N 0 0\n}\n[ExpertDrums]\n{\n768 = N 1 0\n}\n"
+                       "[ExpertDoubleBass]\n{\n768 = N 2 0\n}";
+    const std::vector<SightRead::Detail::NoteEvent> expected_notes {
+        {768, 2, 0}};
+
+    const auto chart = SightRead::Detail::parse_chart(
+        text, {SightRead::Instrument::Guitar, SightRead::Instrument::Bass}, 4);
+
+    BOOST_CHECK_EQUAL(chart.sections.size(), 3);
+    BOOST_CHECK_EQUAL(chart.sections[0].name, "Song");
+    BOOST_CHECK_EQUAL(chart.sections[1].name, "ExpertSingle");
+    BOOST_CHECK_EQUAL(chart.sections[2].name, "ExpertDoubleBass");
+    BOOST_CHECK_EQUAL_COLLECTIONS(chart.sections[2].note_events.cbegin(),
+                                  chart.sections[2].note_events.cend(),
+                                  expected_notes.cbegin(),
+                                  expected_notes.cend());
+}
+
+BOOST_AUTO_TEST_CASE(first_error_in_file_order_is_thrown)
+{
+    const char* text = "[SectionA]\n{\n}\n[SectionB]\n{\n768 = N X 0\n}\n"
+                       "[SectionC]\n{\n768 = B\n}\n[SectionD]\n{\n";
+
+    BOOST_CHECK_EXCEPTION(
+        [&] {
+            return SightRead::Detail::parse_chart(
+                text, SightRead::all_instruments(), 4);
+        }(),
+        SightRead::ParseError,
+        [](const auto& error) {
+            return std::string_view {error.what()} == "Bad note event";
+        });
+}
+
+BOOST_AUTO_TEST_CASE(unfinished_sections_still_throw)
+{
+    const char* text = "[SectionA]\n{\n}\n[SectionB]\n{\n768 = N 0 0\n";
+
+    BOOST_CHECK_THROW(
+        [&] {
+            return SightRead::Detail::parse_chart(
+                text, SightRead::all_instruments(), 4);
+        }(),
+        SightRead::ParseError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(chart_lexer)
+
+BOOST_AUTO_TEST_CASE(sections_are_returned_in_order)
+{
+    const char* text
+        = "[SectionA]\n{\n}\n[ExpertDrums]\n{\n}\n[SectionB]\n{\n}";
+
+    SightRead::Detail::ChartLexer lexer {text,
+                                        {SightRead::Instrument::Guitar}};
+
+    const auto first_section = lexer.next_section();
+    const auto second_section = lexer.next_section();
+
+    BOOST_REQUIRE(first_section.has_value());
+    BOOST_CHECK_EQUAL(first_section->name, "SectionA");
+    BOOST_REQUIRE(second_section.has_value());
+    BOOST_CHECK_EQUAL(second_section->name, "SectionB");
+    BOOST_CHECK(!lexer.next_section().has_value());
+}
+
+BOOST_AUTO_TEST_CASE(errors_are_thrown_when_their_section_is_reached)
+{
+    const char* text = "[SectionA]\n{\n}\n[SectionB]\n{\n768 = N X 0\n}";
+
+    for (auto thread_count : {1U, 4U}) {
+        SightRead::Detail::ChartLexer lexer {
+            text, SightRead::all_instruments(), thread_count};
+
+        const auto first_section = lexer.next_section();
+
+        BOOST_REQUIRE(first_section.has_value());
+        BOOST_CHECK_EQUAL(first_section->name, "SectionA");
+        BOOST_CHECK_THROW([&] { return lexer.next_section(); }(),
+                          SightRead::ParseError);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,21 +1,23 @@
+#include <algorithm>
 #include <tuple>
 
 #include <boost/test/unit_test.hpp>
 
 #include "sightread/detail/midi.hpp"
 #include "sightread/tempomap.hpp"
+#include "testhelpers.hpp"
 
 namespace SightRead::Detail {
 bool operator==(const MetaEvent& lhs, const MetaEvent& rhs)
 {
-    return std::tie(lhs.type, lhs.data) == std::tie(rhs.type, rhs.data);
+    return lhs.type == rhs.type && std::ranges::equal(lhs.data, rhs.data);
 }
 
 std::ostream& operator<<(std::ostream& stream, const MetaEvent& event)
 {
     stream << "{Type " << event.type << ", Data {";
     for (auto i = 0U; i < event.data.size(); ++i) {
-        stream << event.data.at(i);
+        stream << event.data[i];
         if (i + 1 != event.data.size()) {
             stream << ", ";
         }
@@ -38,14 +40,14 @@ std::ostream& operator<<(std::ostream& stream, const MidiEvent& event)
 
 bool operator==(const SysexEvent& lhs, const SysexEvent& rhs)
 {
-    return lhs.data == rhs.data;
+    return std::ranges::equal(lhs.data, rhs.data);
 }
 
 std::ostream& operator<<(std::ostream& stream, const SysexEvent& event)
 {
     stream << "{Data {";
     for (auto i = 0U; i < event.data.size(); ++i) {
-        stream << event.data.at(i);
+        stream << event.data[i];
         if (i + 1 != event.data.size()) {
             stream << ", ";
         }
@@ -91,6 +93,17 @@ midi_from_tracks(const std::vector<std::vector<std::uint8_t>>& track_sections)
     }
     return data;
 }
+
+std::vector<SightRead::Detail::TimedEvent>
+unpacked_events(const SightRead::Detail::MidiTrack& track)
+{
+    std::vector<SightRead::Detail::TimedEvent> events;
+    events.reserve(track.events.size());
+    for (const auto& event : track.events) {
+        events.push_back(track.unpack(event));
+    }
+    return events;
+}
 }
 
 BOOST_AUTO_TEST_CASE(parse_midi_reads_header_correctly)
@@ -189,6 +202,27 @@ BOOST_AUTO_TEST_CASE(five_byte_multi_byte_delta_times_throw)
                       SightRead::ParseError);
 }
 
+BOOST_AUTO_TEST_CASE(four_byte_delta_times_are_parsed_correctly)
+{
+    std::vector<std::uint8_t> track {0x4D, 0x54, 0x72, 0x6B, 0,    0,    0, 7,
+                                     0x81, 0x80, 0x80, 0x00, 0xFF, 2,    0};
+    auto data = midi_from_tracks({track});
+
+    const auto midi = SightRead::Detail::parse_midi(data);
+
+    BOOST_CHECK_EQUAL(midi.tracks[0].events[0].time, 0x200000);
+}
+
+BOOST_AUTO_TEST_CASE(truncated_delta_times_throw)
+{
+    std::vector<std::uint8_t> track {0x4D, 0x54, 0x72, 0x6B, 0,
+                                     0,    0,    2,    0x8F, 0x8F};
+    const auto data = midi_from_tracks({track});
+
+    BOOST_CHECK_THROW([&] { return SightRead::Detail::parse_midi(data); }(),
+                      SightRead::ParseError);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(meta_events_are_read)
@@ -199,13 +233,14 @@ BOOST_AUTO_TEST_CASE(simple_meta_event_is_read)
                                      0x60, 0xFF, 0x51, 3,    8, 0x6B, 0xC3};
     auto data = midi_from_tracks({track});
     std::vector<SightRead::Detail::TimedEvent> events {
-        {0x60, SightRead::Detail::MetaEvent {0x51, {8, 0x6B, 0xC3}}}};
+        {0x60,
+         SightRead::Detail::MetaEvent {0x51, midi_bytes<8, 0x6B, 0xC3>()}}};
 
     const auto midi = SightRead::Detail::parse_midi(data);
+    const auto parsed_events = unpacked_events(midi.tracks[0]);
 
-    BOOST_CHECK_EQUAL_COLLECTIONS(midi.tracks[0].events.cbegin(),
-                                  midi.tracks[0].events.cend(), events.cbegin(),
-                                  events.cend());
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed_events.cbegin(), parsed_events.cend(),
+                                  events.cbegin(), events.cend());
 }
 
 BOOST_AUTO_TEST_CASE(meta_event_with_multi_byte_length_is_read)
@@ -214,13 +249,14 @@ BOOST_AUTO_TEST_CASE(meta_event_with_multi_byte_length_is_read)
                                      0x60, 0xFF, 0x51, 0x80, 3, 8, 0x6B, 0xC3};
     const auto data = midi_from_tracks({track});
     std::vector<SightRead::Detail::TimedEvent> events {
-        {0x60, SightRead::Detail::MetaEvent {0x51, {8, 0x6B, 0xC3}}}};
+        {0x60,
+         SightRead::Detail::MetaEvent {0x51, midi_bytes<8, 0x6B, 0xC3>()}}};
 
     const auto midi = SightRead::Detail::parse_midi(data);
+    const auto parsed_events = unpacked_events(midi.tracks[0]);
 
-    BOOST_CHECK_EQUAL_COLLECTIONS(midi.tracks[0].events.cbegin(),
-                                  midi.tracks[0].events.cend(), events.cbegin(),
-                                  events.cend());
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed_events.cbegin(), parsed_events.cend(),
+                                  events.cbegin(), events.cend());
 }
 
 BOOST_AUTO_TEST_CASE(too_long_meta_events_throw)
@@ -247,10 +283,10 @@ BOOST_AUTO_TEST_CASE(a_single_event_is_read)
         {0, SightRead::Detail::MidiEvent {0x94, {0x7F, 0x64}}}};
 
     const auto midi = SightRead::Detail::parse_midi(data);
+    const auto parsed_events = unpacked_events(midi.tracks[0]);
 
-    BOOST_CHECK_EQUAL_COLLECTIONS(midi.tracks[0].events.cbegin(),
-                                  midi.tracks[0].events.cend(), events.cbegin(),
-                                  events.cend());
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed_events.cbegin(), parsed_events.cend(),
+                                  events.cbegin(), events.cend());
 }
 
 BOOST_AUTO_TEST_CASE(running_status_is_parsed)
@@ -263,10 +299,10 @@ BOOST_AUTO_TEST_CASE(running_status_is_parsed)
         {0x10, SightRead::Detail::MidiEvent {0x94, {0x7F, 0x64}}}};
 
     const auto midi = SightRead::Detail::parse_midi(data);
+    const auto parsed_events = unpacked_events(midi.tracks[0]);
 
-    BOOST_CHECK_EQUAL_COLLECTIONS(midi.tracks[0].events.cbegin(),
-                                  midi.tracks[0].events.cend(), events.cbegin(),
-                                  events.cend());
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed_events.cbegin(), parsed_events.cend(),
+                                  events.cbegin(), events.cend());
 }
 
 BOOST_AUTO_TEST_CASE(running_status_is_not_stopped_by_meta_events)
@@ -320,13 +356,13 @@ BOOST_AUTO_TEST_CASE(simple_sysex_event_is_read)
                                      6,    0x0,  0xF0, 3,    1, 2, 3};
     const auto data = midi_from_tracks({track});
     std::vector<SightRead::Detail::TimedEvent> events {
-        {0, SightRead::Detail::SysexEvent {{1, 2, 3}}}};
+        {0, SightRead::Detail::SysexEvent {midi_bytes<1, 2, 3>()}}};
 
     const auto midi = SightRead::Detail::parse_midi(data);
+    const auto parsed_events = unpacked_events(midi.tracks[0]);
 
-    BOOST_CHECK_EQUAL_COLLECTIONS(midi.tracks[0].events.cbegin(),
-                                  midi.tracks[0].events.cend(), events.cbegin(),
-                                  events.cend());
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed_events.cbegin(), parsed_events.cend(),
+                                  events.cbegin(), events.cend());
 }
 
 BOOST_AUTO_TEST_CASE(sysex_event_with_multi_byte_length_is_read)
@@ -335,13 +371,13 @@ BOOST_AUTO_TEST_CASE(sysex_event_with_multi_byte_length_is_read)
                                      0x0,  0xF0, 0x80, 3,    1, 2, 3};
     const auto data = midi_from_tracks({track});
     std::vector<SightRead::Detail::TimedEvent> events {
-        {0, SightRead::Detail::SysexEvent {{1, 2, 3}}}};
+        {0, SightRead::Detail::SysexEvent {midi_bytes<1, 2, 3>()}}};
 
     const auto midi = SightRead::Detail::parse_midi(data);
+    const auto parsed_events = unpacked_events(midi.tracks[0]);
 
-    BOOST_CHECK_EQUAL_COLLECTIONS(midi.tracks[0].events.cbegin(),
-                                  midi.tracks[0].events.cend(), events.cbegin(),
-                                  events.cend());
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed_events.cbegin(), parsed_events.cend(),
+                                  events.cbegin(), events.cend());
 }
 
 BOOST_AUTO_TEST_CASE(sysex_event_with_too_high_length_throws)
@@ -354,4 +390,124 @@ BOOST_AUTO_TEST_CASE(sysex_event_with_too_high_length_throws)
                       SightRead::ParseError);
 }
 
+BOOST_AUTO_TEST_CASE(sysex_events_past_the_first_256_are_unpacked)
+{
+    SightRead::Detail::MidiTrack track;
+    for (auto i = 0; i < 300; ++i) {
+        track.add_event(i,
+                        SightRead::Detail::SysexEvent {midi_bytes<1, 2, 3>()});
+    }
+    track.add_event(300, SightRead::Detail::SysexEvent {midi_bytes<4>()});
+    const SightRead::Detail::TimedEvent expected_event {
+        300, SightRead::Detail::SysexEvent {midi_bytes<4>()}};
+
+    BOOST_CHECK_EQUAL(track.unpack(track.events.back()), expected_event);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(parallel_track_decoding)
+
+BOOST_AUTO_TEST_CASE(tracks_are_returned_in_file_order)
+{
+    std::vector<std::uint8_t> track_one {0x4D, 0x54, 0x72, 0x6B, 0, 0, 0, 0};
+    std::vector<std::uint8_t> track_two {0x4D, 0x54, 0x72, 0x6B, 0,    0,
+                                         0,    4,    0,    0x85, 0x60, 0};
+    std::vector<std::uint8_t> track_three {
+        0x4D, 0x54, 0x72, 0x6B, 0, 0, 0, 8, 0x60, 0xFF, 2, 0, 0, 0xFF, 2, 0};
+    auto data = midi_from_tracks({track_one, track_two, track_three});
+
+    const auto midi = SightRead::Detail::parse_midi(data, 4);
+
+    BOOST_CHECK_EQUAL(midi.tracks.size(), 3);
+    BOOST_TEST(midi.tracks[0].events.empty());
+    BOOST_CHECK_EQUAL(midi.tracks[1].events.size(), 1);
+    BOOST_CHECK_EQUAL(midi.tracks[2].events.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(bad_track_header_throws_with_worker_threads)
+{
+    std::vector<std::uint8_t> track_one {0x4D, 0x54, 0x72, 0x6B, 0, 0, 0, 0};
+    std::vector<std::uint8_t> bad_track {0x40, 0x54, 0x72, 0x6B, 0, 0, 0, 0};
+    auto data = midi_from_tracks({track_one, bad_track});
+
+    BOOST_CHECK_THROW([&] { return SightRead::Detail::parse_midi(data, 4); }(),
+                      SightRead::ParseError);
+}
+
+BOOST_AUTO_TEST_CASE(first_error_in_file_order_is_thrown)
+{
+    // The first track's event runs past the end of its chunk, so the serial
+    // parse fails reading on into the second track's header bytes.
+    std::vector<std::uint8_t> track_one {0x4D, 0x54, 0x72, 0x6B, 0,   0,
+                                         0,    2,    0,    0xFF, 0x7F, 1};
+    std::vector<std::uint8_t> bad_track {0x40, 0x54, 0x72, 0x6B, 0, 0, 0, 0};
+    auto data = midi_from_tracks({track_one, bad_track});
+
+    const auto error_message = [&](unsigned int thread_count) {
+        try {
+            SightRead::Detail::parse_midi(data, thread_count);
+        } catch (const SightRead::ParseError& e) {
+            return std::string {e.what()};
+        }
+        return std::string {};
+    };
+
+    const auto serial_message = error_message(1);
+
+    BOOST_TEST(!serial_message.empty());
+    BOOST_CHECK_EQUAL(error_message(4), serial_message);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(tracks_can_be_skipped_by_name)
+
+BOOST_AUTO_TEST_CASE(tracks_rejected_by_the_filter_are_left_out)
+{
+    std::vector<std::uint8_t> first_track {0x4D, 0x54, 0x72, 0x6B, 0, 0, 0, 0};
+    std::vector<std::uint8_t> venue_track {0x4D, 0x54, 0x72, 0x6B, 0,   0,
+                                           0,    9,    0,    0xFF, 3,   1,
+                                           0x56, 0,    0x90, 0x60, 0x40};
+    std::vector<std::uint8_t> guitar_track {0x4D, 0x54, 0x72, 0x6B, 0,   0,
+                                            0,    9,    0,    0xFF, 3,   1,
+                                            0x47, 0,    0x90, 0x60, 0x40};
+    const auto data
+        = midi_from_tracks({first_track, venue_track, guitar_track});
+
+    const auto midi = SightRead::Detail::parse_midi(
+        data, 1, [](std::string_view name) { return name == "G"; });
+
+    BOOST_CHECK_EQUAL(midi.tracks.size(), 2);
+    BOOST_CHECK_EQUAL(midi.tracks[1].events.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(first_track_is_never_skipped)
+{
+    std::vector<std::uint8_t> track {0x4D, 0x54, 0x72, 0x6B, 0,   0,   0,
+                                     9,    0,    0xFF, 3,    1,   0x56,
+                                     0,    0x90, 0x60, 0x40};
+    const auto data = midi_from_tracks({track});
+
+    const auto midi = SightRead::Detail::parse_midi(
+        data, 1, [](std::string_view) { return false; });
+
+    BOOST_CHECK_EQUAL(midi.tracks.size(), 1);
+    BOOST_CHECK_EQUAL(midi.tracks[0].events.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(events_after_the_name_of_a_skipped_track_are_not_read)
+{
+    std::vector<std::uint8_t> first_track {0x4D, 0x54, 0x72, 0x6B, 0, 0, 0, 0};
+    std::vector<std::uint8_t> bad_track {0x4D, 0x54, 0x72, 0x6B, 0,   0,
+                                         0,    8,    0,    0xFF, 3,   1,
+                                         0x56, 0,    0xF1, 0};
+    const auto data = midi_from_tracks({first_track, bad_track});
+
+    const auto midi = SightRead::Detail::parse_midi(
+        data, 4, [](std::string_view) { return false; });
+
+    BOOST_CHECK_EQUAL(midi.tracks.size(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,8 +6,9 @@
 namespace {
 SightRead::Detail::MetaEvent part_event(std::string_view name)
 {
-    std::vector<std::uint8_t> bytes {name.cbegin(), name.cend()};
-    return SightRead::Detail::MetaEvent {3, bytes};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(name.data());
+    return SightRead::Detail::MetaEvent {3, {bytes, name.size()}};
 }
 }
 
@@ -47,8 +48,11 @@ BOOST_AUTO_TEST_SUITE(first_track_is_read_correctly)
 BOOST_AUTO_TEST_CASE(tempos_are_read_correctly)
 {
     SightRead::Detail::MidiTrack tempo_track {
-        {{0, {SightRead::Detail::MetaEvent {0x51, {6, 0x1A, 0x80}}}},
-         {1920, {SightRead::Detail::MetaEvent {0x51, {4, 0x93, 0xE0}}}}}};
+        {{0,
+          {SightRead::Detail::MetaEvent {0x51, midi_bytes<6, 0x1A, 0x80>()}}},
+         {1920,
+          {SightRead::Detail::MetaEvent {0x51,
+                                         midi_bytes<4, 0x93, 0xE0>()}}}}};
     const SightRead::Detail::Midi midi {192, {tempo_track}};
     const std::vector<SightRead::BPM> bpms {{SightRead::Tick {0}, 150000},
                                             {SightRead::Tick {1920}, 200000}};
@@ -64,7 +68,7 @@ BOOST_AUTO_TEST_CASE(tempos_are_read_correctly)
 BOOST_AUTO_TEST_CASE(too_short_tempo_events_cause_an_exception)
 {
     SightRead::Detail::MidiTrack tempo_track {
-        {{0, {SightRead::Detail::MetaEvent {0x51, {6, 0x1A}}}}}};
+        {{0, {SightRead::Detail::MetaEvent {0x51, midi_bytes<6, 0x1A>()}}}}};
     const SightRead::Detail::Midi midi {192, {tempo_track}};
     const SightRead::Detail::MidiConverter converter {{}};
 
@@ -75,8 +79,10 @@ BOOST_AUTO_TEST_CASE(too_short_tempo_events_cause_an_exception)
 BOOST_AUTO_TEST_CASE(time_signatures_are_read_correctly)
 {
     SightRead::Detail::MidiTrack ts_track {
-        {{0, {SightRead::Detail::MetaEvent {0x58, {6, 2, 24, 8}}}},
-         {1920, {SightRead::Detail::MetaEvent {0x58, {3, 3, 24, 8}}}}}};
+        {{0, {SightRead::Detail::MetaEvent {0x58, midi_bytes<6, 2, 24, 8>()}}},
+         {1920,
+          {SightRead::Detail::MetaEvent {0x58,
+                                         midi_bytes<3, 3, 24, 8>()}}}}};
     const SightRead::Detail::Midi midi {192, {ts_track}};
     const std::vector<SightRead::TimeSignature> tses {
         {SightRead::Tick {0}, 6, 4}, {SightRead::Tick {1920}, 3, 8}};
@@ -92,7 +98,9 @@ BOOST_AUTO_TEST_CASE(time_signatures_are_read_correctly)
 BOOST_AUTO_TEST_CASE(time_signatures_with_large_denominators_cause_an_exception)
 {
     SightRead::Detail::MidiTrack ts_track {
-        {{0, {SightRead::Detail::MetaEvent {0x58, {6, 32, 24, 8}}}}}};
+        {{0,
+          {SightRead::Detail::MetaEvent {0x58,
+                                         midi_bytes<6, 32, 24, 8>()}}}}};
     const SightRead::Detail::Midi midi {192, {ts_track}};
     const SightRead::Detail::MidiConverter converter {{}};
 
@@ -103,7 +111,7 @@ BOOST_AUTO_TEST_CASE(time_signatures_with_large_denominators_cause_an_exception)
 BOOST_AUTO_TEST_CASE(too_short_time_sig_events_cause_an_exception)
 {
     SightRead::Detail::MidiTrack ts_track {
-        {{0, {SightRead::Detail::MetaEvent {0x58, {6}}}}}};
+        {{0, {SightRead::Detail::MetaEvent {0x58, midi_bytes<6>()}}}}};
     const SightRead::Detail::Midi midi {192, {ts_track}};
     const SightRead::Detail::MidiConverter converter {{}};
 
@@ -114,7 +122,9 @@ BOOST_AUTO_TEST_CASE(too_short_time_sig_events_cause_an_exception)
 BOOST_AUTO_TEST_CASE(song_name_is_not_read_from_midi)
 {
     SightRead::Detail::MidiTrack name_track {
-        {{0, {SightRead::Detail::MetaEvent {1, {72, 101, 108, 108, 111}}}}}};
+        {{0,
+          {SightRead::Detail::MetaEvent {
+              1, midi_bytes<72, 101, 108, 108, 111>()}}}}};
     const SightRead::Detail::Midi midi {192, {name_track}};
 
     const auto song = SightRead::Detail::MidiConverter({}).convert(midi);
@@ -191,8 +201,8 @@ BOOST_AUTO_TEST_CASE(part_guitar_event_need_not_be_the_first_event)
 {
     SightRead::Detail::MidiTrack note_track {
         {{0,
-          {SightRead::Detail::MetaEvent {0x7F,
-                                         {0x05, 0x0F, 0x09, 0x08, 0x40}}}},
+          {SightRead::Detail::MetaEvent {
+              0x7F, midi_bytes<0x05, 0x0F, 0x09, 0x08, 0x40>()}}},
          {0, {part_event("PART GUITAR")}},
          {768, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
          {960, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}}}};
@@ -347,9 +357,11 @@ BOOST_AUTO_TEST_CASE(open_notes_are_read_correctly)
         {{0, {part_event("PART GUITAR")}},
          {768, {SightRead::Detail::MidiEvent {0x90, {96, 64}}}},
          {768,
-          {SightRead::Detail::SysexEvent {{0x50, 0x53, 0, 0, 3, 1, 1, 0xF7}}}},
+          {SightRead::Detail::SysexEvent {
+              midi_bytes<0x50, 0x53, 0, 0, 3, 1, 1, 0xF7>()}}},
          {770,
-          {SightRead::Detail::SysexEvent {{0x50, 0x53, 0, 0, 3, 1, 0, 0xF7}}}},
+          {SightRead::Detail::SysexEvent {
+              midi_bytes<0x50, 0x53, 0, 0, 3, 1, 0, 0xF7>()}}},
          {960, {SightRead::Detail::MidiEvent {0x90, {96, 0}}}}}};
     const SightRead::Detail::Midi midi {192, {note_track}};
 
@@ -368,7 +380,8 @@ BOOST_AUTO_TEST_CASE(parseerror_thrown_if_open_note_ons_have_no_note_offs)
         {{0, {part_event("PART GUITAR")}},
          {768, {SightRead::Detail::MidiEvent {0x90, {96, 64}}}},
          {768,
-          {SightRead::Detail::SysexEvent {{0x50, 0x53, 0, 0, 3, 1, 1, 0xF7}}}},
+          {SightRead::Detail::SysexEvent {
+              midi_bytes<0x50, 0x53, 0, 0, 3, 1, 1, 0xF7>()}}},
          {960, {SightRead::Detail::MidiEvent {0x90, {96, 0}}}}}};
     const SightRead::Detail::Midi midi {192, {note_track}};
     const SightRead::Detail::MidiConverter converter {{}};
@@ -405,6 +418,32 @@ BOOST_AUTO_TEST_CASE(solos_are_read_from_mids_correctly)
                                   solos.cbegin(), solos.cend());
 }
 
+BOOST_AUTO_TEST_CASE(drum_solos_from_mids_count_every_note_in_a_chord)
+{
+    SightRead::Detail::MidiTrack note_track {
+        {{0, {part_event("PART DRUMS")}},
+         {768, {SightRead::Detail::MidiEvent {0x90, {103, 64}}}},
+         {768, {SightRead::Detail::MidiEvent {0x90, {98, 64}}}},
+         {768, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {769, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}},
+         {769, {SightRead::Detail::MidiEvent {0x80, {98, 0}}}},
+         {800, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {801, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}},
+         {900, {SightRead::Detail::MidiEvent {0x80, {103, 64}}}}}};
+    const SightRead::Detail::Midi midi {192, {note_track}};
+    const std::vector<SightRead::Solo> solos {
+        {SightRead::Tick {768}, SightRead::Tick {900}, 300}};
+
+    const auto song = SightRead::Detail::MidiConverter({}).convert(midi);
+    const auto parsed_solos
+        = song.track(SightRead::Instrument::Drums,
+                     SightRead::Difficulty::Expert)
+              .solos(SightRead::DrumSettings::default_settings());
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed_solos.cbegin(), parsed_solos.cend(),
+                                  solos.cbegin(), solos.cend());
+}
+
 BOOST_AUTO_TEST_SUITE(star_power_is_read)
 
 BOOST_AUTO_TEST_CASE(a_single_phrase_is_read)
@@ -621,6 +660,38 @@ BOOST_AUTO_TEST_CASE(taps_are_read)
                       SightRead::FLAGS_TAP | SightRead::FLAGS_FIVE_FRET_GUITAR);
 }
 
+BOOST_AUTO_TEST_CASE(notes_between_tap_sections_are_not_taps)
+{
+    SightRead::Detail::MidiTrack note_track {
+        {{0, {part_event("PART GUITAR")}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {96, 64}}}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {104, 64}}}},
+         {1, {SightRead::Detail::MidiEvent {0x80, {96, 0}}}},
+         {100, {SightRead::Detail::MidiEvent {0x80, {104, 0}}}},
+         {200, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {201, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}},
+         {400, {SightRead::Detail::MidiEvent {0x90, {98, 64}}}},
+         {400, {SightRead::Detail::MidiEvent {0x90, {104, 64}}}},
+         {401, {SightRead::Detail::MidiEvent {0x80, {98, 0}}}},
+         {500, {SightRead::Detail::MidiEvent {0x80, {104, 0}}}},
+         {600, {SightRead::Detail::MidiEvent {0x90, {99, 64}}}},
+         {601, {SightRead::Detail::MidiEvent {0x80, {99, 0}}}}}};
+    const SightRead::Detail::Midi midi {480, {note_track}};
+
+    const auto song = SightRead::Detail::MidiConverter({}).convert(midi);
+    const auto notes = song.track(SightRead::Instrument::Guitar,
+                                  SightRead::Difficulty::Expert)
+                           .notes();
+
+    BOOST_REQUIRE_EQUAL(notes.size(), 4);
+    BOOST_CHECK_EQUAL(notes[0].flags,
+                      SightRead::FLAGS_TAP | SightRead::FLAGS_FIVE_FRET_GUITAR);
+    BOOST_CHECK_EQUAL(notes[1].flags, SightRead::FLAGS_FIVE_FRET_GUITAR);
+    BOOST_CHECK_EQUAL(notes[2].flags,
+                      SightRead::FLAGS_TAP | SightRead::FLAGS_FIVE_FRET_GUITAR);
+    BOOST_CHECK_EQUAL(notes[3].flags, SightRead::FLAGS_FIVE_FRET_GUITAR);
+}
+
 BOOST_AUTO_TEST_CASE(taps_take_precedence_over_hopos)
 {
     SightRead::Detail::MidiTrack note_track {
@@ -944,17 +1015,17 @@ BOOST_AUTO_TEST_CASE(disco_flips_are_read_correctly_from_mid)
     SightRead::Detail::MidiTrack note_track {
         {{0, {part_event("PART DRUMS")}},
          {15,
-          {SightRead::Detail::MetaEvent {1,
-                                         {0x5B, 0x6D, 0x69, 0x78, 0x20, 0x33,
-                                          0x20, 0x64, 0x72, 0x75, 0x6D, 0x73,
-                                          0x30, 0x64, 0x5D}}}},
+          {SightRead::Detail::MetaEvent {
+              1,
+              midi_bytes<0x5B, 0x6D, 0x69, 0x78, 0x20, 0x33, 0x20, 0x64, 0x72,
+                         0x75, 0x6D, 0x73, 0x30, 0x64, 0x5D>()}}},
          {45, {SightRead::Detail::MidiEvent {0x90, {98, 64}}}},
          {65, {SightRead::Detail::MidiEvent {0x80, {98, 0}}}},
          {75,
-          {SightRead::Detail::MetaEvent {1,
-                                         {0x5B, 0x6D, 0x69, 0x78, 0x20, 0x33,
-                                          0x20, 0x64, 0x72, 0x75, 0x6D, 0x73,
-                                          0x30, 0x5D}}}}}};
+          {SightRead::Detail::MetaEvent {
+              1,
+              midi_bytes<0x5B, 0x6D, 0x69, 0x78, 0x20, 0x33, 0x20, 0x64, 0x72,
+                         0x75, 0x6D, 0x73, 0x30, 0x5D>()}}}}};
     const SightRead::Detail::Midi midi {192, {note_track}};
     const auto song = SightRead::Detail::MidiConverter({}).convert(midi);
     const auto& track = song.track(SightRead::Instrument::Drums,
@@ -973,10 +1044,10 @@ BOOST_AUTO_TEST_CASE(missing_disco_flip_end_event_just_ends_at_max_int)
     SightRead::Detail::MidiTrack note_track {
         {{0, {part_event("PART DRUMS")}},
          {15,
-          {SightRead::Detail::MetaEvent {1,
-                                         {0x5B, 0x6D, 0x69, 0x78, 0x20, 0x33,
-                                          0x20, 0x64, 0x72, 0x75, 0x6D, 0x73,
-                                          0x30, 0x64, 0x5D}}}},
+          {SightRead::Detail::MetaEvent {
+              1,
+              midi_bytes<0x5B, 0x6D, 0x69, 0x78, 0x20, 0x33, 0x20, 0x64, 0x72,
+                         0x75, 0x6D, 0x73, 0x30, 0x64, 0x5D>()}}},
          {45, {SightRead::Detail::MidiEvent {0x90, {98, 64}}}},
          {65, {SightRead::Detail::MidiEvent {0x80, {98, 0}}}}}};
     const SightRead::Detail::Midi midi {192, {note_track}};
@@ -1019,15 +1090,37 @@ BOOST_AUTO_TEST_CASE(drum_five_lane_to_four_lane_conversion_is_done_from_mid)
                                   notes.cbegin(), notes.cend());
 }
 
+BOOST_AUTO_TEST_CASE(blue_cymbals_before_the_first_five_lane_green_are_toms)
+{
+    SightRead::Detail::MidiTrack note_track {
+        {{0, {part_event("PART DRUMS")}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {99, 64}}}},
+         {1, {SightRead::Detail::MidiEvent {0x80, {99, 0}}}},
+         {2, {SightRead::Detail::MidiEvent {0x90, {101, 64}}}},
+         {3, {SightRead::Detail::MidiEvent {0x80, {101, 0}}}}}};
+    const SightRead::Detail::Midi midi {192, {note_track}};
+    const auto song = SightRead::Detail::MidiConverter({}).convert(midi);
+    const auto& track = song.track(SightRead::Instrument::Drums,
+                                   SightRead::Difficulty::Expert);
+
+    std::vector<SightRead::Note> notes {
+        make_drum_note(0, SightRead::DRUM_BLUE),
+        make_drum_note(2, SightRead::DRUM_GREEN)};
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(track.notes().cbegin(), track.notes().cend(),
+                                  notes.cbegin(), notes.cend());
+}
+
 BOOST_AUTO_TEST_CASE(dynamics_are_parsed_from_mid)
 {
     SightRead::Detail::MidiTrack note_track {
         {{0, {part_event("PART DRUMS")}},
          {0,
-          {SightRead::Detail::MetaEvent {1, {0x5B, 0x45, 0x4E, 0x41, 0x42, 0x4C,
-                                             0x45, 0x5F, 0x43, 0x48, 0x41, 0x52,
-                                             0x54, 0x5F, 0x44, 0x59, 0x4E, 0x41,
-                                             0x4D, 0x49, 0x43, 0x53, 0x5D}}}},
+          {SightRead::Detail::MetaEvent {
+              1,
+              midi_bytes<0x5B, 0x45, 0x4E, 0x41, 0x42, 0x4C, 0x45, 0x5F, 0x43,
+                         0x48, 0x41, 0x52, 0x54, 0x5F, 0x44, 0x59, 0x4E, 0x41,
+                         0x4D, 0x49, 0x43, 0x53, 0x5D>()}}},
          {0, {SightRead::Detail::MidiEvent {0x90, {97, 1}}}},
          {1, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}},
          {2, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
@@ -1048,6 +1141,33 @@ BOOST_AUTO_TEST_CASE(dynamics_are_parsed_from_mid)
                                   notes.cbegin(), notes.cend());
 }
 
+BOOST_AUTO_TEST_CASE(dynamics_are_parsed_when_enabled_after_the_notes)
+{
+    SightRead::Detail::MidiTrack note_track {
+        {{0, {part_event("PART DRUMS")}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {97, 1}}}},
+         {1, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}},
+         {2, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {3, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}},
+         {4,
+          {SightRead::Detail::MetaEvent {
+              1,
+              midi_bytes<0x5B, 0x45, 0x4E, 0x41, 0x42, 0x4C, 0x45, 0x5F, 0x43,
+                         0x48, 0x41, 0x52, 0x54, 0x5F, 0x44, 0x59, 0x4E, 0x41,
+                         0x4D, 0x49, 0x43, 0x53, 0x5D>()}}}}};
+    const SightRead::Detail::Midi midi {192, {note_track}};
+    const auto song = SightRead::Detail::MidiConverter({}).convert(midi);
+    const auto& track = song.track(SightRead::Instrument::Drums,
+                                   SightRead::Difficulty::Expert);
+
+    std::vector<SightRead::Note> notes {
+        make_drum_note(0, SightRead::DRUM_RED, SightRead::FLAGS_GHOST),
+        make_drum_note(2, SightRead::DRUM_RED)};
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(track.notes().cbegin(), track.notes().cend(),
+                                  notes.cbegin(), notes.cend());
+}
+
 BOOST_AUTO_TEST_CASE(dynamics_not_parsed_from_mid_without_ENABLE_CHART_DYNAMICS)
 {
     SightRead::Detail::MidiTrack note_track {
@@ -1071,6 +1191,20 @@ BOOST_AUTO_TEST_CASE(dynamics_not_parsed_from_mid_without_ENABLE_CHART_DYNAMICS)
                                   notes.cbegin(), notes.cend());
 }
 
+BOOST_AUTO_TEST_CASE(drum_note_ons_merged_by_flags_each_need_a_note_off)
+{
+    SightRead::Detail::MidiTrack note_track {
+        {{0, {part_event("PART DRUMS")}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {97, 1}}}},
+         {2, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {3, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}}}};
+    const SightRead::Detail::Midi midi {192, {note_track}};
+    const SightRead::Detail::MidiConverter converter {{}};
+
+    BOOST_CHECK_THROW([&] { return converter.convert(midi); }(),
+                      SightRead::ParseError);
+}
+
 BOOST_AUTO_TEST_CASE(instruments_not_permitted_are_dropped_from_midis)
 {
     SightRead::Detail::MidiTrack guitar_track {
@@ -1096,6 +1230,18 @@ BOOST_AUTO_TEST_CASE(instruments_not_permitted_are_dropped_from_midis)
                                   expected_instruments.cend());
 }
 
+BOOST_AUTO_TEST_CASE(only_permitted_instrument_and_beat_tracks_are_needed)
+{
+    const auto converter
+        = SightRead::Detail::MidiConverter({}).permit_instruments(
+            {SightRead::Instrument::Guitar});
+
+    BOOST_TEST(converter.is_track_needed("PART GUITAR"));
+    BOOST_TEST(converter.is_track_needed("BEAT"));
+    BOOST_TEST(!converter.is_track_needed("PART BASS"));
+    BOOST_TEST(!converter.is_track_needed("VENUE"));
+}
+
 BOOST_AUTO_TEST_CASE(solos_ignored_from_midis_if_not_permitted)
 {
     SightRead::Detail::MidiTrack note_track {
@@ -1118,3 +1264,59 @@ BOOST_AUTO_TEST_CASE(solos_ignored_from_midis_if_not_permitted)
 
     BOOST_CHECK(parsed_solos.empty());
 }
+
+BOOST_AUTO_TEST_CASE(instrument_tracks_are_converted_with_worker_threads)
+{
+    SightRead::Detail::MidiTrack guitar_track {
+        {{0, {part_event("PART GUITAR")}},
+         {768, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {960, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}}}};
+    SightRead::Detail::MidiTrack second_guitar_track {
+        {{0, {part_event("T1 GEMS")}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {96, 64}}}},
+         {65, {SightRead::Detail::MidiEvent {0x80, {96, 0}}}}}};
+    SightRead::Detail::MidiTrack drum_track {
+        {{0, {part_event("PART DRUMS")}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {1, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}}}};
+    SightRead::Detail::MidiTrack ghl_track {
+        {{0, {part_event("PART GUITAR GHL")}},
+         {0, {SightRead::Detail::MidiEvent {0x90, {94, 64}}}},
+         {65, {SightRead::Detail::MidiEvent {0x80, {94, 0}}}}}};
+    const SightRead::Detail::Midi midi {
+        192, {guitar_track, second_guitar_track, drum_track, ghl_track}};
+    const std::vector<SightRead::Instrument> expected_instruments {
+        SightRead::Instrument::Guitar, SightRead::Instrument::GHLGuitar,
+        SightRead::Instrument::Drums};
+
+    const auto song
+        = SightRead::Detail::MidiConverter({}).worker_threads(4).convert(midi);
+    const auto instruments = song.instruments();
+    const auto& guitar_notes
+        = song.track(SightRead::Instrument::Guitar,
+                     SightRead::Difficulty::Expert)
+              .notes();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(instruments.cbegin(), instruments.cend(),
+                                  expected_instruments.cbegin(),
+                                  expected_instruments.cend());
+    BOOST_REQUIRE_EQUAL(guitar_notes.size(), 1);
+    BOOST_CHECK_EQUAL(guitar_notes[0].position, SightRead::Tick {768});
+}
+
+BOOST_AUTO_TEST_CASE(first_error_in_file_order_is_thrown_with_worker_threads)
+{
+    SightRead::Detail::MidiTrack guitar_track {
+        {{0, {part_event("PART GUITAR")}},
+         {768, {SightRead::Detail::MidiEvent {0x90, {96, 64}}}}}};
+    SightRead::Detail::MidiTrack bass_track {
+        {{0, {part_event("PART BASS")}},
+         {768, {SightRead::Detail::MidiEvent {0x90, {97, 64}}}},
+         {960, {SightRead::Detail::MidiEvent {0x80, {97, 0}}}}}};
+    const SightRead::Detail::Midi midi {192, {guitar_track, bass_track}};
+    const auto converter
+        = SightRead::Detail::MidiConverter({}).worker_threads(4);
+
+    BOOST_CHECK_THROW([&] { return converter.convert(midi); }(),
+                      SightRead::ParseError);
+}
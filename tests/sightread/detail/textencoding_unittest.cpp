@@ -0,0 +1,74 @@
+#include <string>
+#include <string_view>
+
+#include <boost/test/unit_test.hpp>
+
+#include "sightread/detail/textencoding.hpp"
+
+namespace {
+// Encodes ASCII text as UTF-16 with a BOM.
+std::string utf16_from_ascii(std::string_view text, bool is_big_endian)
+{
+    std::string data {is_big_endian ? "\xFE\xFF" : "\xFF\xFE"};
+    for (auto c : text) {
+        if (is_big_endian) {
+            data.push_back('\0');
+            data.push_back(c);
+        } else {
+            data.push_back(c);
+            data.push_back('\0');
+        }
+    }
+    return data;
+}
+}
+
+BOOST_AUTO_TEST_CASE(text_without_utf16_bom_is_not_transcoded)
+{
+    BOOST_CHECK(!SightRead::Detail::transcode_utf16("[Song]").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(ascii_utf16_is_transcoded)
+{
+    const std::string_view text {"[Song]\r\n{\r\n  Resolution = 192\r\n}"};
+
+    for (auto is_big_endian : {false, true}) {
+        const auto utf8_text = SightRead::Detail::transcode_utf16(
+            utf16_from_ascii(text, is_big_endian));
+
+        BOOST_REQUIRE(utf8_text.has_value());
+        BOOST_CHECK_EQUAL(*utf8_text, text);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(non_ascii_utf16_is_transcoded)
+{
+    // "aé€" followed by U+1F3B8 as a surrogate pair.
+    const std::string data {"\xFF\xFE"
+                            "a\0\xE9\0\xAC\x20\x3C\xD8\xB8\xDF",
+                            12};
+
+    const auto utf8_text = SightRead::Detail::transcode_utf16(data);
+
+    BOOST_REQUIRE(utf8_text.has_value());
+    BOOST_CHECK_EQUAL(*utf8_text, "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x8E\xB8");
+}
+
+BOOST_AUTO_TEST_CASE(unpaired_surrogates_and_odd_bytes_are_replaced)
+{
+    const std::string data {"\xFE\xFF\xD8\x3C\0a\xDF\xB8\0", 9};
+
+    const auto utf8_text = SightRead::Detail::transcode_utf16(data);
+
+    BOOST_REQUIRE(utf8_text.has_value());
+    BOOST_CHECK_EQUAL(*utf8_text,
+                      "\xEF\xBF\xBD"
+                      "a\xEF\xBF\xBD\xEF\xBF\xBD");
+}
+
+BOOST_AUTO_TEST_CASE(utf8_bom_is_skipped)
+{
+    BOOST_CHECK_EQUAL(SightRead::Detail::skip_utf8_bom("\xEF\xBB\xBF[Song]"),
+                      "[Song]");
+    BOOST_CHECK_EQUAL(SightRead::Detail::skip_utf8_bom("[Song]"), "[Song]");
+}
@@ -0,0 +1,102 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "sightread/fileparser.hpp"
+#include "sightread/tempomap.hpp"
+
+namespace {
+// A file in the temporary directory that is deleted when this goes out of
+// scope.
+class TempFile {
+private:
+    std::filesystem::path m_path;
+
+public:
+    TempFile(const std::string& name, const std::vector<std::uint8_t>& data)
+        : m_path {std::filesystem::temp_directory_path() / name}
+    {
+        std::ofstream file {m_path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+    }
+    ~TempFile()
+    {
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+    }
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+    TempFile(TempFile&&) = delete;
+    TempFile& operator=(TempFile&&) = delete;
+
+    [[nodiscard]] const std::filesystem::path& path() const { return m_path; }
+};
+
+std::vector<std::uint8_t> bytes_from_string(const std::string& text)
+{
+    return {text.cbegin(), text.cend()};
+}
+}
+
+BOOST_AUTO_TEST_CASE(chart_files_are_parsed)
+{
+    const TempFile file {"sightread_test.chart",
+                         bytes_from_string("[Song]\n{\nResolution = 480\n}\n"
+                                           "[ExpertSingle]\n{\n768 = N 0 0\n}")};
+
+    const auto song = SightRead::parse_file(file.path());
+
+    BOOST_CHECK_EQUAL(song.global_data().resolution(), 480);
+    BOOST_CHECK_EQUAL(song.instruments().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(utf8_bom_is_skipped_in_chart_files)
+{
+    auto data = bytes_from_string(
+        "[Song]\n{\nResolution = 480\n}\n[ExpertSingle]\n{\n768 = N 0 0\n}");
+    data.insert(data.begin(), {0xEF, 0xBB, 0xBF});
+    const TempFile file {"sightread_test_bom.chart", data};
+
+    const auto song = SightRead::parse_file(file.path());
+
+    BOOST_CHECK_EQUAL(song.global_data().resolution(), 480);
+}
+
+BOOST_AUTO_TEST_CASE(midi_files_are_detected_by_header)
+{
+    const std::vector<std::uint8_t> data {
+        0x4D, 0x54, 0x68, 0x64, 0,    0,    0,    6,    0,    1,    0,
+        1,    1,    0xE0, 0x4D, 0x54, 0x72, 0x6B, 0,    0,    0,    0x1B,
+        0,    0xFF, 3,    11,   'P',  'A',  'R',  'T',  ' ',  'G',  'U',
+        'I',  'T',  'A',  'R',  0,    0x90, 0x60, 0x40, 0x10, 0x80, 0x60,
+        0x40, 0,    0xFF, 0x2F, 0};
+    const TempFile file {"sightread_test.chart", data};
+
+    const auto song = SightRead::parse_file(file.path());
+
+    BOOST_CHECK(song.global_data().is_from_midi());
+    BOOST_CHECK_EQUAL(song.instruments().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(missing_files_throw)
+{
+    const auto path = std::filesystem::temp_directory_path()
+        / "sightread_test_missing.chart";
+
+    BOOST_CHECK_THROW([&] { return SightRead::parse_file(path); }(),
+                      std::system_error);
+}
+
+BOOST_AUTO_TEST_CASE(empty_files_are_parsed_as_charts)
+{
+    const TempFile file {"sightread_test_empty.chart", {}};
+
+    BOOST_CHECK_THROW([&] { return SightRead::parse_file(file.path()); }(),
+                      SightRead::ParseError);
+}
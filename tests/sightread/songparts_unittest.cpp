@@ -42,6 +42,25 @@ BOOST_AUTO_TEST_CASE(notes_are_sorted)
                                   sorted_notes.cbegin(), sorted_notes.cend());
 }
 
+BOOST_AUTO_TEST_CASE(unsorted_duplicate_notes_are_merged_before_hopos_are_set)
+{
+    std::vector<SightRead::Note> notes {
+        make_note(50, 0, SightRead::FIVE_FRET_RED), make_note(0),
+        make_note(50, 10, SightRead::FIVE_FRET_RED)};
+    SightRead::NoteTrack track {notes,
+                                {},
+                                SightRead::TrackType::FiveFret,
+                                std::make_shared<SightRead::SongGlobalData>()};
+    auto hopo_note = make_note(50, 10, SightRead::FIVE_FRET_RED);
+    hopo_note.flags = static_cast<SightRead::NoteFlags>(
+        hopo_note.flags | SightRead::FLAGS_HOPO);
+    std::vector<SightRead::Note> required_notes {make_note(0), hopo_note};
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(track.notes().cbegin(), track.notes().cend(),
+                                  required_notes.cbegin(),
+                                  required_notes.cend());
+}
+
 BOOST_AUTO_TEST_CASE(notes_of_the_same_colour_and_position_are_merged)
 {
     std::vector<SightRead::Note> notes {make_note(768, 0), make_note(768, 768)};
@@ -441,6 +460,18 @@ BOOST_AUTO_TEST_CASE(base_score_is_correctly_handled_with_open_note_merging)
     BOOST_CHECK_EQUAL(track.base_score(), 50);
 }
 
+BOOST_AUTO_TEST_CASE(note_sustain_ticks_count_equal_chord_sustains_once)
+{
+    const auto equal_chord = make_chord(
+        0, {{SightRead::FIVE_FRET_GREEN, 96}, {SightRead::FIVE_FRET_RED, 96}});
+    const auto disjoint_chord = make_chord(
+        0, {{SightRead::FIVE_FRET_GREEN, 96}, {SightRead::FIVE_FRET_RED, 0}});
+
+    BOOST_CHECK_EQUAL(make_note(0, 50).sustain_ticks(), SightRead::Tick {50});
+    BOOST_CHECK_EQUAL(equal_chord.sustain_ticks(), SightRead::Tick {96});
+    BOOST_CHECK_EQUAL(disjoint_chord.sustain_ticks(), SightRead::Tick {96});
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(base_score_is_correct_for_drums)
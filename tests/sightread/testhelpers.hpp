@@ -1,11 +1,23 @@
 #ifndef SIGHTREAD_TESTHELPERS_HPP
 #define SIGHTREAD_TESTHELPERS_HPP
 
+#include <array>
+#include <cstdint>
 #include <ostream>
+#include <span>
 #include <tuple>
 
 #include "sightread/songparts.hpp"
 
+// MIDI meta and sysex events only view their data, so tests need the bytes to
+// have static storage.
+template <std::uint8_t... Bytes> std::span<const std::uint8_t> midi_bytes()
+{
+    static constexpr std::array<std::uint8_t, sizeof...(Bytes)> BYTES {
+        Bytes...};
+    return BYTES;
+}
+
 inline SightRead::Note make_note(int position, int length = 0,
                                  SightRead::FiveFretNotes colour
                                  = SightRead::FIVE_FRET_GREEN)